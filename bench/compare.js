@@ -0,0 +1,61 @@
+'use strict';
+
+// Compares two JSON reports produced by bench/index.js, exiting with a non
+// zero status if any benchmark regressed by more than the threshold.
+//
+//   node bench/compare.js before.json after.json [thresholdPercent]
+
+const fs = require('fs');
+
+function load(file) {
+  return JSON.parse(fs.readFileSync(file, 'utf8'));
+}
+
+function pct(before, after) {
+  return before === 0 ? 0 : (after - before) / before * 100;
+}
+
+function fmt(n) {
+  const s = n.toFixed(1);
+  return n > 0 ? `+${s}%` : `${s}%`;
+}
+
+function main() {
+  if (process.argv.length < 4) {
+    console.error('usage: compare.js before.json after.json [threshold]');
+    process.exit(2);
+  }
+  const before = load(process.argv[2]);
+  const after = load(process.argv[3]);
+  const threshold = process.argv.length > 4 ? Number(process.argv[4]) : 10;
+  let regressions = 0;
+
+  console.log(`${before.commit} -> ${after.commit}`);
+
+  for (const name of Object.keys(after.results)) {
+    const b = before.results[name];
+
+    if (!b) {
+      console.log(`  ${name}: new`);
+      continue;
+    }
+    const a = after.results[name];
+    const ops = pct(b.opsPerSec, a.opsPerSec);
+    const p99 = pct(b.p99BatchNs, a.p99BatchNs);
+    const regressed = ops < -threshold || p99 > threshold;
+
+    if (regressed) {
+      regressions++;
+    }
+    console.log(`${regressed ? '! ' : '  '}${name}: ops/sec ${fmt(ops)}, ` +
+      `p99 batch ${fmt(p99)}`);
+  }
+
+  if (regressions > 0) {
+    console.log(`${regressions} benchmark(s) regressed by more than ` +
+      `${threshold}%`);
+    process.exit(1);
+  }
+}
+
+main();
@@ -0,0 +1,234 @@
+'use strict';
+
+// A stand-in for the Atlas publish and LWC endpoints, so the whole publish
+// pipeline can be exercised on one machine without the backend.
+//
+//   node bench/fake-atlas.js --port 7101 --delay 20
+//
+// --port <n>       port to listen on, 0 for any (default 7101)
+// --delay <ms>     delay before answering publish and evaluate batches, to
+//                  simulate a slow backend (default 0)
+// --parse <0|1>    decompress and parse batches to count their metrics
+//                  (default 1)
+//
+// Endpoints:
+//   POST /api/v1/publish*      publish batches
+//   POST /lwc/api/v1/evaluate  LWC evaluation batches
+//   GET  /lwc/api/v1/expressions/<cluster>  the configured subscriptions
+//   GET  /stats                what was received so far, see stats()
+//   POST /reset                forget what was received
+//
+// Used as a module by the tests and bench/publish.js:
+//   const server = fakeAtlas.create({subscriptions: [...]});
+//   server.listen(0, () => { ... server.urls() ... server.stats() ... });
+
+const http = require('http');
+const zlib = require('zlib');
+
+const MAX_LATENCIES = 10000;
+
+function emptyEndpointStats() {
+  return {
+    batches: 0,
+    metrics: 0,
+    bytes: 0,
+    uncompressedBytes: 0,
+    errors: 0,
+    // ms from the first to the last byte of each request body
+    latencies: []
+  };
+}
+
+function percentile(sorted, p) {
+  if (sorted.length === 0) {
+    return 0;
+  }
+  const idx = Math.min(sorted.length - 1,
+    Math.floor(p / 100 * sorted.length));
+  return Number(sorted[idx].toFixed(3));
+}
+
+function summarize(endpoint, elapsedSecs) {
+  const sorted = endpoint.latencies.slice().sort((a, b) => a - b);
+  return {
+    batches: endpoint.batches,
+    metrics: endpoint.metrics,
+    bytes: endpoint.bytes,
+    uncompressedBytes: endpoint.uncompressedBytes,
+    errors: endpoint.errors,
+    metricsPerSec: Number((endpoint.metrics / elapsedSecs).toFixed(1)),
+    bytesPerBatch: endpoint.batches > 0 ?
+      Math.round(endpoint.bytes / endpoint.batches) : 0,
+    latencyMs: {
+      p50: percentile(sorted, 50),
+      p99: percentile(sorted, 99),
+      max: percentile(sorted, 100)
+    }
+  };
+}
+
+// number of metrics in a publish ({metrics: [...]}) or evaluate
+// ({metrics: [...]}) payload
+function countMetrics(payload) {
+  const body = JSON.parse(payload);
+  return Array.isArray(body.metrics) ? body.metrics.length : 0;
+}
+
+function readBody(req, cb) {
+  const chunks = [];
+  let first = 0;
+  req.on('data', (chunk) => {
+    if (chunks.length === 0) {
+      first = process.hrtime.bigint();
+    }
+    chunks.push(chunk);
+  });
+  req.on('end', () => {
+    const ms = chunks.length > 0 ?
+      Number(process.hrtime.bigint() - first) / 1e6 : 0;
+    cb(Buffer.concat(chunks), ms);
+  });
+}
+
+function decode(req, body) {
+  const encoding = req.headers['content-encoding'];
+  return encoding === 'gzip' ? zlib.gunzipSync(body) : body;
+}
+
+class FakeAtlas {
+  constructor(options) {
+    const opts = options || {};
+    this.delay = opts.delay || 0;
+    this.parse = opts.parse !== false;
+    this.subscriptions = opts.subscriptions || [];
+    this.server = http.createServer((req, res) => this.handle(req, res));
+    this.reset();
+  }
+
+  reset() {
+    this.started = Date.now();
+    this.publish = emptyEndpointStats();
+    this.evaluate = emptyEndpointStats();
+    this.subscriptionRequests = 0;
+  }
+
+  listen(port, cb) {
+    this.server.listen(port, '127.0.0.1', cb);
+    return this;
+  }
+
+  close(cb) {
+    this.server.close(cb);
+  }
+
+  port() {
+    return this.server.address().port;
+  }
+
+  // the config entries that point the client at this server
+  urls(cluster) {
+    const base = `http://127.0.0.1:${this.port()}`;
+    return {
+      publishUrl: `${base}/api/v1/publish-fast`,
+      evaluateUrl: `${base}/lwc/api/v1/evaluate`,
+      subscriptionsUrl: `${base}/lwc/api/v1/expressions/${cluster || 'local'}`
+    };
+  }
+
+  stats() {
+    const elapsedSecs = Math.max((Date.now() - this.started) / 1000, 0.001);
+    return {
+      elapsedSecs: elapsedSecs,
+      publish: summarize(this.publish, elapsedSecs),
+      evaluate: summarize(this.evaluate, elapsedSecs),
+      subscriptionRequests: this.subscriptionRequests
+    };
+  }
+
+  receive(endpoint, req, res) {
+    readBody(req, (body, ms) => {
+      endpoint.batches++;
+      endpoint.bytes += body.length;
+
+      if (endpoint.latencies.length < MAX_LATENCIES) {
+        endpoint.latencies.push(ms);
+      }
+      let status = 200;
+
+      if (this.parse) {
+        try {
+          const payload = decode(req, body);
+          endpoint.uncompressedBytes += payload.length;
+          endpoint.metrics += countMetrics(payload);
+        } catch (e) {
+          endpoint.errors++;
+          status = 400;
+        }
+      }
+      setTimeout(() => {
+        res.writeHead(status, {'Content-Type': 'application/json'});
+        res.end('{}');
+      }, this.delay);
+    });
+  }
+
+  handle(req, res) {
+    const url = req.url;
+
+    if (req.method === 'POST' && url.startsWith('/api/v1/publish')) {
+      this.receive(this.publish, req, res);
+    } else if (req.method === 'POST' &&
+        url.startsWith('/lwc/api/v1/evaluate')) {
+      this.receive(this.evaluate, req, res);
+    } else if (req.method === 'GET' &&
+        url.startsWith('/lwc/api/v1/expressions')) {
+      this.subscriptionRequests++;
+      res.writeHead(200, {'Content-Type': 'application/json'});
+      res.end(JSON.stringify({expressions: this.subscriptions}));
+    } else if (req.method === 'GET' && url === '/stats') {
+      res.writeHead(200, {'Content-Type': 'application/json'});
+      res.end(JSON.stringify(this.stats()));
+    } else if (req.method === 'POST' && url === '/reset') {
+      this.reset();
+      res.writeHead(204);
+      res.end();
+    } else {
+      res.writeHead(404);
+      res.end();
+    }
+  }
+}
+
+function create(options) {
+  return new FakeAtlas(options);
+}
+
+module.exports = {
+  create: create
+};
+
+function parseArgs(argv) {
+  const args = {
+    port: 7101,
+    delay: 0,
+    parse: 1
+  };
+
+  for (let i = 0; i < argv.length; ++i) {
+    const key = argv[i].replace(/^--/, '');
+
+    if (!(key in args)) {
+      throw new Error(`Unknown option ${argv[i]}`);
+    }
+    args[key] = Number(argv[++i]);
+  }
+  return args;
+}
+
+if (require.main === module) {
+  const args = parseArgs(process.argv.slice(2));
+  const server = create({delay: args.delay, parse: args.parse !== 0});
+  server.listen(args.port, () => {
+    console.log(JSON.stringify(server.urls(), null, 2));
+  });
+}
@@ -0,0 +1,99 @@
+'use strict';
+
+// Minimal benchmark harness: runs a function in batches, reporting the
+// throughput and the distribution of the mean call time of each batch, then
+// times a subset of the calls individually for the per call percentiles.
+
+function nanos(hr) {
+  return hr[0] * 1e9 + hr[1];
+}
+
+function percentile(sorted, p) {
+  if (sorted.length === 0) {
+    return 0;
+  }
+  const idx = Math.min(sorted.length - 1,
+    Math.ceil(p / 100 * sorted.length) - 1);
+  return sorted[Math.max(0, idx)];
+}
+
+function round(n) {
+  return Math.round(n * 100) / 100;
+}
+
+// the median cost of the two clock reads around a call, subtracted from each
+// individually timed call
+function clockOverheadNs() {
+  const samples = [];
+
+  for (let i = 0; i < 1000; ++i) {
+    const start = process.hrtime.bigint();
+    samples.push(Number(process.hrtime.bigint() - start));
+  }
+  samples.sort((a, b) => a - b);
+  return percentile(samples, 50);
+}
+
+// up to n calls timed one by one, continuing from iteration first
+function timeCalls(fn, first, n) {
+  const overhead = clockOverheadNs();
+  const samples = [];
+
+  for (let i = 0; i < n; ++i) {
+    const start = process.hrtime.bigint();
+    fn(first + i);
+    const elapsed = Number(process.hrtime.bigint() - start);
+    samples.push(Math.max(0, elapsed - overhead));
+  }
+  samples.sort((a, b) => a - b);
+  return samples;
+}
+
+// fn(i) is called batchSize times per sample. Timing a batch instead of
+// individual calls keeps the cost of process.hrtime() out of the results
+function measure(fn, options) {
+  const opts = options || {};
+  const batchSize = opts.batchSize || 100;
+  const minSamples = opts.minSamples || 50;
+  const maxSamples = opts.maxSamples || 10000;
+  const minTimeNs = (opts.minTimeMs || 500) * 1e6;
+  const warmup = opts.warmup || 1000;
+
+  for (let i = 0; i < warmup; ++i) {
+    fn(i);
+  }
+
+  const batchMeans = [];
+  let totalNs = 0;
+  let calls = 0;
+
+  while (batchMeans.length < maxSamples &&
+    (batchMeans.length < minSamples || totalNs < minTimeNs)) {
+    const start = process.hrtime();
+
+    for (let i = 0; i < batchSize; ++i) {
+      fn(calls + i);
+    }
+    const elapsed = nanos(process.hrtime(start));
+    totalNs += elapsed;
+    calls += batchSize;
+    batchMeans.push(elapsed / batchSize);
+  }
+
+  batchMeans.sort((a, b) => a - b);
+  // with batches of one call the batch means are already per call
+  const perCall = batchSize === 1 ? batchMeans :
+    timeCalls(fn, calls, Math.min(opts.perCallSamples || 10000, calls));
+  return {
+    calls: calls,
+    opsPerSec: Math.round(calls / (totalNs / 1e9)),
+    meanNs: round(totalNs / calls),
+    p50Ns: round(percentile(perCall, 50)),
+    p99Ns: round(percentile(perCall, 99)),
+    p50BatchNs: round(percentile(batchMeans, 50)),
+    p99BatchNs: round(percentile(batchMeans, 99))
+  };
+}
+
+module.exports.measure = measure;
+module.exports.percentile = percentile;
@@ -0,0 +1,144 @@
+'use strict';
+
+// Runs the microbenchmarks, printing a table to stderr and writing the
+// results as JSON to stdout or to the file given with --out.
+//
+//   npm run bench -- --filter counter --out before.json
+//   node bench/compare.js before.json after.json
+//
+// The client is configured from an atlas-config.json in a temporary
+// directory pointing at a bench/fake-atlas.js child process, so push() never
+// reaches the configured backend. It is a separate process because push()
+// blocks the event loop until the server answers.
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const childProcess = require('child_process');
+const harness = require('./harness');
+
+function parseArgs(argv) {
+  const args = {
+    filter: null,
+    out: null
+  };
+
+  for (let i = 0; i < argv.length; ++i) {
+    if (argv[i] === '--filter') {
+      args.filter = new RegExp(argv[++i]);
+    } else if (argv[i] === '--out') {
+      args.out = argv[++i];
+    }
+  }
+  return args;
+}
+
+function gitCommit() {
+  try {
+    return childProcess.execSync('git rev-parse --short HEAD', {
+      cwd: __dirname,
+      stdio: ['ignore', 'pipe', 'ignore']
+    }).toString().trim();
+  } catch (e) {
+    return 'unknown';
+  }
+}
+
+function pad(s, n) {
+  const str = String(s);
+  return str.length >= n ? str : str + ' '.repeat(n - str.length);
+}
+
+// starts bench/fake-atlas.js on any port, cb(child, urls) once it listens
+function startFakeAtlas(cb) {
+  const child = childProcess.spawn(process.execPath,
+    [path.join(__dirname, 'fake-atlas.js'), '--port', '0', '--parse', '0'],
+    {stdio: ['ignore', 'pipe', 'inherit']});
+  let out = '';
+  const onData = (chunk) => {
+    out += chunk;
+    let urls;
+
+    try {
+      urls = JSON.parse(out);
+    } catch (e) {
+      // not all of it yet
+      return;
+    }
+    child.stdout.removeListener('data', onData);
+    cb(child, urls);
+  };
+  child.stdout.on('data', onData);
+}
+
+function writeConfig(urls) {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'atlas-bench-'));
+  fs.writeFileSync(path.join(dir, 'atlas-config.json'),
+    JSON.stringify(urls, null, 2));
+  return dir;
+}
+
+function run(args) {
+  // loads the addon, which reads its config from the current directory
+  const suites = require('./suites');
+  const results = {};
+
+  console.error(`${pad('benchmark', 32)} ${pad('ops/sec', 12)} ` +
+    `${pad('mean ns', 12)} ${pad('p99 ns', 12)} p99 batch ns`);
+
+  for (const c of suites.cases) {
+    if (args.filter && !args.filter.test(c.name)) {
+      continue;
+    }
+    const r = harness.measure(c.setup(), c.options);
+
+    if (c.teardown) {
+      c.teardown();
+    }
+    results[c.name] = r;
+    console.error(`${pad(c.name, 32)} ${pad(r.opsPerSec, 12)} ` +
+      `${pad(r.meanNs, 12)} ${pad(r.p99Ns, 12)} ${r.p99BatchNs}`);
+  }
+
+  const report = {
+    commit: gitCommit(),
+    date: new Date().toISOString(),
+    node: process.version,
+    platform: `${os.platform()}-${os.arch()}`,
+    cpu: os.cpus().length > 0 ? os.cpus()[0].model : 'unknown',
+    fastCalls: suites.fastCalls,
+    skipped: suites.skipped,
+    results: results
+  };
+  const json = JSON.stringify(report, null, 2);
+
+  if (args.out) {
+    fs.writeFileSync(args.out, `${json}\n`);
+  } else {
+    console.log(json);
+  }
+}
+
+function main() {
+  const args = parseArgs(process.argv.slice(2));
+  const cwd = process.cwd();
+
+  if (args.out) {
+    args.out = path.resolve(args.out);
+  }
+  startFakeAtlas((child, urls) => {
+    const dir = writeConfig(urls);
+    process.chdir(dir);
+
+    try {
+      run(args);
+    } finally {
+      process.chdir(cwd);
+      fs.unlinkSync(path.join(dir, 'atlas-config.json'));
+      fs.rmdirSync(dir);
+      child.kill();
+    }
+  });
+}
+
+main();
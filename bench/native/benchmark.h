@@ -0,0 +1,180 @@
+#pragma once
+
+// A tiny subset of the Google Benchmark API, enough to write benchmarks in
+// the same style without adding a dependency to the build:
+//
+//   static void BM_Foo(benchmark::State& state) {
+//     for (auto _ : state) { ... }
+//   }
+//   BENCHMARK(BM_Foo)->Arg(1)->Arg(8);
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace benchmark {
+
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class State {
+ public:
+  State(int64_t iterations, std::vector<int64_t> args)
+      : iterations_{iterations}, args_{std::move(args)} {}
+
+  int64_t range(size_t i = 0) const { return args_.at(i); }
+  int64_t iterations() const { return iterations_; }
+  void SetLabel(const std::string& label) { label_ = label; }
+  const std::string& label() const { return label_; }
+
+  // the timed region is the range-for loop over the state, so any setup
+  // done before the loop is not measured
+  class Iterator {
+   public:
+    Iterator(State* state, int64_t remaining)
+        : state_{state}, remaining_{remaining} {}
+    bool operator!=(const Iterator&) const {
+      if (remaining_ > 0) {
+        return true;
+      }
+      state_->stop_ = std::chrono::steady_clock::now();
+      return false;
+    }
+    void operator++() { --remaining_; }
+    // non-trivial so `for (auto _ : state)` does not warn about an unused
+    // variable
+    struct Value {
+      ~Value() {}
+    };
+    Value operator*() const { return Value{}; }
+
+   private:
+    State* state_;
+    int64_t remaining_;
+  };
+  Iterator begin() {
+    start_ = std::chrono::steady_clock::now();
+    return Iterator{this, iterations_};
+  }
+  Iterator end() { return Iterator{this, 0}; }
+
+  std::chrono::nanoseconds Elapsed() const { return stop_ - start_; }
+
+ private:
+  int64_t iterations_;
+  std::vector<int64_t> args_;
+  std::string label_;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point stop_;
+};
+
+using Function = void (*)(State&);
+
+class Benchmark {
+ public:
+  Benchmark(const char* name, Function fn) : name_{name}, fn_{fn} {}
+
+  Benchmark* Arg(int64_t arg) {
+    args_.push_back({arg});
+    return this;
+  }
+  Benchmark* Args(std::vector<int64_t> args) {
+    args_.push_back(std::move(args));
+    return this;
+  }
+
+  void Run(const char* filter) const;
+
+ private:
+  std::string name_;
+  Function fn_;
+  std::vector<std::vector<int64_t>> args_;
+
+  double RunOnce(const std::vector<int64_t>& args, int64_t iterations,
+                 std::string* label) const {
+    State state{iterations, args};
+    fn_(state);
+    auto elapsed = state.Elapsed();
+    *label = state.label();
+    return static_cast<double>(elapsed.count());
+  }
+};
+
+inline std::vector<Benchmark*>& registered() {
+  static std::vector<Benchmark*> benchmarks;
+  return benchmarks;
+}
+
+inline Benchmark* RegisterBenchmark(const char* name, Function fn) {
+  auto b = new Benchmark{name, fn};
+  registered().push_back(b);
+  return b;
+}
+
+// grow the iteration count until a run takes at least 100ms, then report
+// the time per iteration
+inline void Benchmark::Run(const char* filter) const {
+  std::vector<std::vector<int64_t>> all_args = args_;
+  if (all_args.empty()) {
+    all_args.push_back({});
+  }
+  for (const auto& args : all_args) {
+    std::string name = name_;
+    for (auto a : args) {
+      name += "/" + std::to_string(a);
+    }
+    if (filter != nullptr && name.find(filter) == std::string::npos) {
+      continue;
+    }
+
+    std::string label;
+    int64_t iterations = 1;
+    double elapsed = 0;
+    while (true) {
+      elapsed = RunOnce(args, iterations, &label);
+      if (elapsed >= 1e8 || iterations >= 1000000000) {
+        break;
+      }
+      auto scale = elapsed > 0 ? 1.4e8 / elapsed : 10.0;
+      scale = std::min(std::max(scale, 1.5), 10.0);
+      iterations =
+          static_cast<int64_t>(static_cast<double>(iterations) * scale);
+    }
+    printf("%-48s %12.1f ns %12lld %s\n", name.c_str(),
+           elapsed / static_cast<double>(iterations),
+           static_cast<long long>(iterations), label.c_str());
+  }
+}
+
+inline int RunSpecifiedBenchmarks(int argc, char** argv) {
+  const char* filter = nullptr;
+  for (auto i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--benchmark_filter=", 19) == 0) {
+      filter = argv[i] + 19;
+    }
+  }
+  printf("%-48s %15s %12s\n", "Benchmark", "Time", "Iterations");
+  for (const auto* b : registered()) {
+    b->Run(filter);
+  }
+  return 0;
+}
+
+}  // namespace benchmark
+
+#define BENCHMARK_CONCAT2(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT2(a, b)
+#define BENCHMARK(fn)                                             \
+  static ::benchmark::Benchmark* BENCHMARK_CONCAT(bm_, __LINE__) \
+      __attribute__((unused)) = ::benchmark::RegisterBenchmark(#fn, fn)
+
+#define BENCHMARK_MAIN()                                   \
+  int main(int argc, char** argv) {                        \
+    return ::benchmark::RunSpecifiedBenchmarks(argc, argv); \
+  }
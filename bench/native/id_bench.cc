@@ -0,0 +1,119 @@
+// Benchmarks for the V8-free part of building ids: validating and adding
+// tags, creating ids, and the dev mode validation.
+//
+//   node-gyp configure -- -Datlas_bench=1 && node-gyp build
+//   ./build/Release/atlas_bench --benchmark_filter=CreateId
+
+#include "../../src/id_builder.h"
+#include "benchmark.h"
+#include <atlas/atlas_client.h>
+#include <atlas/meter/validation.h>
+
+using atlas::meter::AnalyzeTags;
+using atlas::meter::Tag;
+using atlas::meter::Tags;
+
+static atlas::meter::Registry* registry() {
+  static atlas::Client client;
+  return client.GetRegistry().get();
+}
+
+// count distinct key/value pairs, each about len characters long
+static std::vector<std::pair<std::string, std::string>> tag_strings(
+    int64_t count, int64_t len) {
+  std::vector<std::pair<std::string, std::string>> result;
+  for (auto i = 0; i < count; ++i) {
+    auto suffix = std::to_string(i);
+    auto pad = len > static_cast<int64_t>(suffix.size())
+                   ? static_cast<size_t>(len) - suffix.size()
+                   : 0;
+    result.emplace_back(std::string(pad, 'k') + suffix,
+                        std::string(pad, 'v') + suffix);
+  }
+  return result;
+}
+
+static Tags make_tags(int64_t count, int64_t len) {
+  Tags tags;
+  std::string err_msg;
+  for (const auto& kv : tag_strings(count, len)) {
+    add_tag(kv.first, kv.second, &tags, &err_msg);
+  }
+  return tags;
+}
+
+static void BM_AddTags(benchmark::State& state) {
+  auto strings = tag_strings(state.range(0), state.range(1));
+  std::string err_msg;
+  for (auto _ : state) {
+    Tags tags;
+    for (const auto& kv : strings) {
+      add_tag(kv.first, kv.second, &tags, &err_msg);
+    }
+    benchmark::DoNotOptimize(tags);
+  }
+}
+BENCHMARK(BM_AddTags)
+    ->Args({1, 8})
+    ->Args({4, 8})
+    ->Args({8, 8})
+    ->Args({16, 8})
+    ->Args({4, 32})
+    ->Args({4, 128});
+
+static void BM_CreateId(benchmark::State& state) {
+  auto tags = make_tags(state.range(0), state.range(1));
+  auto r = registry();
+  for (auto _ : state) {
+    auto id = r->CreateId("bench.id", tags);
+    benchmark::DoNotOptimize(id);
+  }
+}
+BENCHMARK(BM_CreateId)
+    ->Args({0, 8})
+    ->Args({1, 8})
+    ->Args({4, 8})
+    ->Args({8, 8})
+    ->Args({16, 8})
+    ->Args({4, 128});
+
+static void BM_WithTag(benchmark::State& state) {
+  auto id = registry()->CreateId("bench.id", make_tags(state.range(0), 8));
+  auto tag = Tag::of("statistic", "percentile");
+  for (auto _ : state) {
+    auto with_tag = id->WithTag(tag);
+    benchmark::DoNotOptimize(with_tag);
+  }
+}
+BENCHMARK(BM_WithTag)->Arg(0)->Arg(4)->Arg(16);
+
+static void BM_AnalyzeTags(benchmark::State& state) {
+  auto tags = make_tags(state.range(0), state.range(1));
+  tags.add("name", "bench.id");
+  for (auto _ : state) {
+    auto issues = AnalyzeTags(tags);
+    benchmark::DoNotOptimize(issues);
+  }
+}
+BENCHMARK(BM_AnalyzeTags)
+    ->Args({1, 8})
+    ->Args({4, 8})
+    ->Args({16, 8})
+    ->Args({4, 128});
+
+// dev mode path: validation plus formatting the message for invalid ids
+static void BM_ValidateId(benchmark::State& state) {
+  auto tags = make_tags(state.range(0), 8);
+  if (state.range(1) != 0) {
+    tags.add("bad key!", "bad value!");
+  }
+  state.SetLabel(state.range(1) != 0 ? "invalid" : "valid");
+  auto has_errors = false;
+  for (auto _ : state) {
+    auto msg = validate_id("bench.id", tags, &has_errors);
+    benchmark::DoNotOptimize(msg);
+  }
+}
+BENCHMARK(BM_ValidateId)->Args({4, 0})->Args({4, 1});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,143 @@
+'use strict';
+
+// Measures end-to-end publish throughput and its CPU cost against the fake
+// Atlas server in bench/fake-atlas.js, without the backend.
+//
+//   node bench/publish.js --meters 100000 --batchSize 1000,10000 --duration 150
+//
+// --meters <n>       counters to create and keep updating (default 100000)
+// --batchSize <list> comma separated batchSize settings, one run each
+//                    (default 10000)
+// --duration <s>     how long each run lasts. Metrics are published once a
+//                    minute, so use at least 130 to see two publishes
+//                    (default 150)
+// --delay <ms>       how long the fake server takes to answer (default 0)
+//
+// Each run is a fresh node process started in a temporary directory with an
+// atlas-config.json that points the publish, evaluate and subscriptions urls
+// at the fake server. The report has, per batchSize, what the server
+// received (batches, metrics, bytes, body latencies) and the user and system
+// CPU time of the client process. A first run with publishing disabled, as
+// batchSize null, gives the CPU time spent updating the meters.
+
+const childProcess = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const fakeAtlas = require('./fake-atlas');
+
+const UPDATE_PERIOD_MS = 5000;
+
+function parseArgs(argv) {
+  const args = {
+    meters: 100000,
+    batchSize: '10000',
+    duration: 150,
+    delay: 0
+  };
+
+  for (let i = 0; i < argv.length; ++i) {
+    const key = argv[i].replace(/^--/, '');
+
+    if (!(key in args)) {
+      throw new Error(`Unknown option ${argv[i]}`);
+    }
+    const value = argv[++i];
+    args[key] = key === 'batchSize' ? value : Number(value);
+  }
+  return args;
+}
+
+// runs in the child process: creates the meters, keeps them updated and
+// prints its CPU usage as one JSON line once stopped
+function child(meters, durationSecs) {
+  const atlas = require(path.join(__dirname, '..'));
+  atlas.start({runtimeMetrics: false});
+
+  const counters = [];
+
+  for (let i = 0; i < meters; ++i) {
+    counters.push(atlas.counter('bench.publish', {id: String(i)}));
+  }
+  const update = () => {
+    for (const c of counters) {
+      c.increment();
+    }
+  };
+  update();
+  const cpuStart = process.cpuUsage();
+  const timer = setInterval(update, UPDATE_PERIOD_MS);
+
+  setTimeout(() => {
+    clearInterval(timer);
+    atlas.stop();
+    const cpu = process.cpuUsage(cpuStart);
+    console.log(JSON.stringify({
+      userMs: cpu.user / 1000,
+      systemMs: cpu.system / 1000
+    }));
+  }, durationSecs * 1000);
+}
+
+function run(server, args, batchSize, cb) {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'atlas-publish-'));
+  const config = Object.assign({
+    publishEnabled: batchSize !== null,
+    publishConfig: [':true,:all']
+  }, server.urls());
+
+  if (batchSize !== null) {
+    config.batchSize = batchSize;
+  }
+  fs.writeFileSync(path.join(dir, 'atlas-config.json'),
+    JSON.stringify(config, null, 2));
+
+  server.reset();
+  childProcess.execFile(process.execPath,
+    [__filename, '--child', String(args.meters), String(args.duration)],
+    {cwd: dir, maxBuffer: 16 * 1024 * 1024}, (err, stdout) => {
+      fs.unlinkSync(path.join(dir, 'atlas-config.json'));
+      fs.rmdirSync(dir);
+
+      if (err) {
+        cb(err);
+        return;
+      }
+      const cpu = JSON.parse(stdout.toString().trim().split('\n').pop());
+      cb(null, {batchSize: batchSize, client: cpu, server: server.stats()});
+    });
+}
+
+function main() {
+  const args = parseArgs(process.argv.slice(2));
+  const batchSizes = [null].concat(args.batchSize.split(',').map(Number));
+  const server = fakeAtlas.create({delay: args.delay});
+  const results = [];
+
+  const next = (i) => {
+    if (i === batchSizes.length) {
+      server.close();
+      console.log(JSON.stringify({
+        node: process.version,
+        meters: args.meters,
+        durationSecs: args.duration,
+        results: results
+      }, null, 2));
+      return;
+    }
+    run(server, args, batchSizes[i], (err, result) => {
+      if (err) {
+        throw err;
+      }
+      results.push(result);
+      next(i + 1);
+    });
+  };
+  server.listen(0, () => next(0));
+}
+
+if (process.argv[2] === '--child') {
+  child(Number(process.argv[3]), Number(process.argv[4]));
+} else {
+  main();
+}
@@ -0,0 +1,328 @@
+'use strict';
+
+// Replays a recorded metric stream (one JSON object per line, see
+// test/metrics-test.txt) against the client to size hosts for a workload.
+//
+//   node bench/replay.js --rate 50000 --cardinality 100 --concurrency 4 \
+//     --workers 2 --duration 60
+//
+// --file <path>        recorded stream (default test/metrics-test.txt)
+// --rate <n>           metrics per second per worker, 0 for as fast as
+//                      possible (default 10000)
+// --cardinality <n>    replay each recorded id as n distinct ids (default 1)
+// --concurrency <n>    producers interleaved on each event loop (default 1)
+// --workers <n>        cluster workers, each replaying at --rate (default 1)
+// --duration <s>       how long to run (default 30)
+// --publish            publish to the configured endpoints instead of a
+//                      local bench/fake-atlas.js server
+//
+// The client is started with runtime metrics so the report can include the
+// nodejs.eventLoopLag and nodejs.gc.pause timers. Unless --publish is given,
+// the workers run in a temporary directory whose atlas-config.json points
+// the publish, evaluate and subscriptions urls at a fake server started by
+// the master, so the publish pipeline is exercised without reaching the
+// backend.
+
+const cluster = require('cluster');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const fakeAtlas = require('./fake-atlas');
+
+const TICK_MS = 10;
+const UNBOUNDED_BATCH = 1000;
+
+function parseArgs(argv) {
+  const args = {
+    file: path.join(__dirname, '..', 'test', 'metrics-test.txt'),
+    rate: 10000,
+    cardinality: 1,
+    concurrency: 1,
+    workers: 1,
+    duration: 30,
+    publish: false
+  };
+
+  for (let i = 0; i < argv.length; ++i) {
+    const key = argv[i].replace(/^--/, '');
+
+    if (!(key in args)) {
+      throw new Error(`Unknown option ${argv[i]}`);
+    }
+
+    if (key === 'publish') {
+      args.publish = true;
+      continue;
+    }
+    const value = argv[++i];
+    // resolved now, workers change into the config directory
+    args[key] = key === 'file' ? path.resolve(value) : Number(value);
+  }
+  return args;
+}
+
+// a directory with an atlas-config.json publishing to the fake server
+function writeConfig(urls) {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'atlas-replay-'));
+  const config = Object.assign({
+    publishEnabled: true,
+    publishConfig: [':true,:all']
+  }, urls);
+  fs.writeFileSync(path.join(dir, 'atlas-config.json'),
+    JSON.stringify(config, null, 2));
+  return dir;
+}
+
+function removeConfig(dir) {
+  fs.unlinkSync(path.join(dir, 'atlas-config.json'));
+  fs.rmdirSync(dir);
+}
+
+function loadEntries(file) {
+  return fs.readFileSync(file, 'utf8').split('\n')
+    .filter((line) => line.trim().length > 0)
+    .map((line) => {
+      const entry = JSON.parse(line);
+      entry.tags = entry.tags || {};
+      return entry;
+    });
+}
+
+// expand the recorded entries into cardinality distinct ids each
+function expand(entries, cardinality) {
+  if (cardinality <= 1) {
+    return entries;
+  }
+  const result = [];
+
+  for (let shard = 0; shard < cardinality; ++shard) {
+    for (const e of entries) {
+      result.push({
+        type: e.type,
+        name: e.name,
+        tags: Object.assign({
+          'replay.shard': String(shard)
+        }, e.tags),
+        value: e.value
+      });
+    }
+  }
+  return result;
+}
+
+function processMetric(atlas, entry) {
+  switch (entry.type) {
+    case 'TIMER':
+      atlas.timer(entry.name, entry.tags).record(0, entry.value * 1e6);
+      break;
+    case 'GAUGE':
+      atlas.gauge(entry.name, entry.tags).update(entry.value);
+      break;
+    case 'COUNTER':
+      atlas.dcounter(entry.name, entry.tags).increment(entry.value);
+      break;
+    default:
+      atlas.counter('replay.errors', {
+        err: 'unknownType'
+      }).increment();
+  }
+}
+
+// totalTime() is in seconds
+function timerStats(timer) {
+  const count = timer.count();
+  const totalMs = timer.totalTime() * 1000;
+  return {
+    count: count,
+    totalMs: totalMs,
+    meanMs: count > 0 ? totalMs / count : 0
+  };
+}
+
+function gcStats(atlas, tags) {
+  const ids = ['scavenge', 'markSweepCompact', 'incrementalMarking',
+    'processWeakCallbacks'];
+  const result = {
+    count: 0,
+    totalMs: 0
+  };
+
+  for (const id of ids) {
+    const stats = timerStats(atlas.timer('nodejs.gc.pause',
+      Object.assign({
+        id: id
+      }, tags)));
+    result.count += stats.count;
+    result.totalMs += stats.totalMs;
+  }
+  return result;
+}
+
+// a producer replays entries from its own offset, spending a share of the
+// rate budget every tick
+function startProducer(atlas, entries, offset, rate, deadline, state) {
+  let pos = offset % entries.length;
+  let last = Date.now();
+  let owed = 0;
+
+  const tick = () => {
+    const now = Date.now();
+
+    if (now >= deadline) {
+      state.running--;
+      return;
+    }
+
+    let n = UNBOUNDED_BATCH;
+
+    if (rate > 0) {
+      owed += (now - last) / 1000 * rate;
+      n = Math.floor(owed);
+      owed -= n;
+    }
+    last = now;
+
+    for (let i = 0; i < n; ++i) {
+      processMetric(atlas, entries[pos]);
+      pos = (pos + 1) % entries.length;
+    }
+    state.ops += n;
+
+    if (rate > 0) {
+      setTimeout(tick, TICK_MS);
+    } else {
+      setImmediate(tick);
+    }
+  };
+  tick();
+}
+
+function runWorker(args, done) {
+  if (process.env.ATLAS_REPLAY_CONFIG_DIR) {
+    process.chdir(process.env.ATLAS_REPLAY_CONFIG_DIR);
+  }
+  const atlas = require('..');
+  atlas.start({
+    runtimeMetrics: true
+  });
+
+  const runtimeTags = {
+    'nodejs.version': process.version
+  };
+  const entries = expand(loadEntries(args.file), args.cardinality);
+  const concurrency = Math.max(1, args.concurrency);
+  const start = Date.now();
+  const deadline = start + args.duration * 1000;
+  const rssStart = process.memoryUsage().rss;
+  const gcStart = gcStats(atlas, runtimeTags);
+  const state = {
+    ops: 0,
+    running: concurrency
+  };
+  const step = Math.floor(entries.length / concurrency);
+
+  for (let i = 0; i < concurrency; ++i) {
+    startProducer(atlas, entries, i * step, args.rate / concurrency,
+      deadline, state);
+  }
+
+  const wait = setInterval(() => {
+    if (state.running > 0) {
+      return;
+    }
+    clearInterval(wait);
+
+    const elapsed = (Math.min(Date.now(), deadline) - start) / 1000;
+    const gcEnd = gcStats(atlas, runtimeTags);
+    const rssEnd = process.memoryUsage().rss;
+    const report = {
+      pid: process.pid,
+      ops: state.ops,
+      opsPerSec: Math.round(state.ops / elapsed),
+      distinctIds: entries.length,
+      eventLoopLag: timerStats(atlas.timer('nodejs.eventLoopLag',
+        runtimeTags)),
+      rss: {
+        start: rssStart,
+        end: rssEnd,
+        growth: rssEnd - rssStart
+      },
+      gcPause: {
+        count: gcEnd.count - gcStart.count,
+        totalMs: gcEnd.totalMs - gcStart.totalMs
+      }
+    };
+    atlas.stop();
+    done(report);
+  }, 100);
+}
+
+function summarize(args, reports) {
+  const sum = (f) => reports.reduce((acc, r) => acc + f(r), 0);
+  const lagCount = sum((r) => r.eventLoopLag.count);
+  return {
+    options: args,
+    workers: reports.length,
+    opsPerSec: sum((r) => r.opsPerSec),
+    eventLoopLagMeanMs: lagCount > 0 ?
+      sum((r) => r.eventLoopLag.totalMs) / lagCount : 0,
+    rssGrowth: sum((r) => r.rss.growth),
+    gcPauseMs: sum((r) => r.gcPause.totalMs),
+    perWorker: reports
+  };
+}
+
+function replay(args, done) {
+  if (args.workers <= 1) {
+    runWorker(args, (report) => {
+      console.log(JSON.stringify(summarize(args, [report]), null, 2));
+      done();
+    });
+    return;
+  }
+
+  const reports = [];
+
+  for (let i = 0; i < args.workers; ++i) {
+    cluster.fork();
+  }
+  cluster.on('message', (worker, report) => {
+    reports.push(report);
+
+    if (reports.length === args.workers) {
+      console.log(JSON.stringify(summarize(args, reports), null, 2));
+      done();
+    }
+  });
+}
+
+function main() {
+  const args = parseArgs(process.argv.slice(2));
+
+  if (args.publish) {
+    replay(args, () => {});
+    return;
+  }
+  const server = fakeAtlas.create({parse: false});
+  server.listen(0, () => {
+    const dir = writeConfig(server.urls());
+    // inherited by the cluster workers
+    process.env.ATLAS_REPLAY_CONFIG_DIR = dir;
+    replay(args, () => {
+      removeConfig(dir);
+      server.close();
+    });
+  });
+}
+
+module.exports.timerStats = timerStats;
+
+if (require.main !== module) {
+  // required by the tests
+} else if (cluster.isMaster) {
+  main();
+} else {
+  runWorker(parseArgs(process.argv.slice(2)), (report) => {
+    process.send(report, () => process.exit(0));
+  });
+}
@@ -0,0 +1,95 @@
+'use strict';
+
+// Measures cold start: each run is a fresh node process that requires the
+// module and starts the client, either with start() or with startAsync().
+//
+//   node bench/startup.js --runs 20
+//
+// For each mode it reports, in milliseconds:
+//   require  time to load the module
+//   blocked  time the event loop was blocked by the start call
+//   ready    time until publishing has started
+//
+// Runtime metrics are disabled so only the client startup is measured.
+
+const childProcess = require('child_process');
+const path = require('path');
+
+const MODES = ['start', 'startAsync'];
+
+function parseArgs(argv) {
+  const args = {
+    runs: 10
+  };
+
+  for (let i = 0; i < argv.length; ++i) {
+    if (argv[i] === '--runs') {
+      args.runs = Number(argv[++i]);
+    }
+  }
+  return args;
+}
+
+// runs in the child process, prints one JSON line with the timings
+function child(mode) {
+  const toMs = (from, to) => Number(to - from) / 1e6;
+  const t0 = process.hrtime.bigint();
+  const atlas = require(path.join(__dirname, '..'));
+  const t1 = process.hrtime.bigint();
+  const options = {runtimeMetrics: false};
+  const report = (t2, t3) => {
+    console.log(JSON.stringify({
+      require: toMs(t0, t1),
+      blocked: toMs(t1, t2),
+      ready: toMs(t1, t3)
+    }));
+    atlas.stop();
+  };
+
+  if (mode === 'startAsync') {
+    const promise = atlas.startAsync(options);
+    const t2 = process.hrtime.bigint();
+    promise.then(() => report(t2, process.hrtime.bigint()));
+  } else {
+    atlas.start(options);
+    const t2 = process.hrtime.bigint();
+    report(t2, t2);
+  }
+}
+
+function median(values) {
+  const sorted = values.slice().sort((a, b) => a - b);
+  return Number(sorted[Math.floor(sorted.length / 2)].toFixed(2));
+}
+
+function main() {
+  const args = parseArgs(process.argv.slice(2));
+  const results = {};
+
+  for (const mode of MODES) {
+    const runs = [];
+
+    for (let i = 0; i < args.runs; ++i) {
+      const out = childProcess.execFileSync(process.execPath,
+        [__filename, '--child', mode]);
+      runs.push(JSON.parse(out.toString().trim().split('\n').pop()));
+    }
+    results[mode] = {
+      runs: runs.length,
+      require: median(runs.map((r) => r.require)),
+      blocked: median(runs.map((r) => r.blocked)),
+      ready: median(runs.map((r) => r.ready))
+    };
+  }
+
+  console.log(JSON.stringify({
+    node: process.version,
+    results: results
+  }, null, 2));
+}
+
+if (process.argv[2] === '--child') {
+  child(process.argv[3]);
+} else {
+  main();
+}
@@ -0,0 +1,485 @@
+'use strict';
+
+// One entry per function exported by InitAll (src/atlas.cc), except the ones
+// listed in skipped. Each case has a setup function returning the function
+// to measure, which receives the iteration number, and optionally a teardown
+// function run after it.
+
+const atlas = require('bindings')('atlas');
+// adds timeAsync to JsTimer
+require('..');
+
+const TAGS = {
+  nf_app: 'bench',
+  status: '200'
+};
+
+const bucketFunction = {
+  function: 'latency',
+  value: 3,
+  unit: 's'
+};
+
+// meters currently registered by the measurements() cases
+let populated = 0;
+
+function populate(size) {
+  for (let i = populated; i < size; ++i) {
+    atlas.gauge('bench.populated', {
+      id: String(i)
+    }).update(i);
+  }
+  populated = Math.max(populated, size);
+}
+
+function measurementsCase(size) {
+  return {
+    name: `measurements.${size}`,
+    options: {
+      batchSize: 1,
+      minSamples: 5,
+      maxSamples: 200,
+      warmup: 1
+    },
+    setup: () => {
+      populate(size);
+      return () => atlas.measurements();
+    }
+  };
+}
+
+function cursorCase(size) {
+  return {
+    name: `measurementsCursor.${size}`,
+    options: {
+      batchSize: 1,
+      minSamples: 5,
+      maxSamples: 200,
+      warmup: 1
+    },
+    setup: () => {
+      populate(size);
+      return () => {
+        const cursor = atlas.measurementsCursor(1000);
+
+        while (!cursor.done()) {
+          cursor.next();
+        }
+      };
+    }
+  };
+}
+
+// every call registers a new lazy gauge, dispose them so the snapshot taken
+// by the measurements cases does not refresh them
+function functionGaugeCase() {
+  const gauges = [];
+  return {
+    name: 'functionGauge.create',
+    options: {
+      maxSamples: 100
+    },
+    setup: () => (i) => gauges.push(atlas.functionGauge(
+      'bench.functionGauge', {
+        id: String(i)
+      }, () => i)),
+    teardown: () => {
+      for (const g of gauges) {
+        g.dispose();
+      }
+      gauges.length = 0;
+    }
+  };
+}
+
+function pushCase(size) {
+  return {
+    name: `push.${size}`,
+    options: {
+      batchSize: 1,
+      minSamples: 5,
+      maxSamples: 500,
+      warmup: 1
+    },
+    setup: () => {
+      const now = Date.now();
+      const batch = [];
+
+      for (let i = 0; i < size; ++i) {
+        batch.push({
+          name: 'bench.push',
+          tags: {
+            id: String(i)
+          },
+          timestamp: now,
+          value: i
+        });
+      }
+      return () => atlas.push(batch);
+    }
+  };
+}
+
+const cases = [
+  {
+    name: 'validateNameAndTags',
+    setup: () => () => atlas.validateNameAndTags('bench.validate', TAGS)
+  },
+  {
+    name: 'config',
+    setup: () => () => atlas.config()
+  },
+  {
+    name: 'setDevMode',
+    setup: () => () => atlas.setDevMode(false)
+  },
+  {
+    name: 'counter.lookup',
+    setup: () => () => atlas.counter('bench.counter', TAGS)
+  },
+  {
+    name: 'counter.increment',
+    setup: () => {
+      const c = atlas.counter('bench.counter', TAGS);
+      return () => c.increment();
+    }
+  },
+  {
+    name: 'counter.add',
+    setup: () => {
+      const c = atlas.counter('bench.counter', TAGS);
+      return (i) => c.add(i % 8);
+    }
+  },
+  {
+    name: 'counter.addDouble',
+    setup: () => {
+      const c = atlas.counter('bench.counter', TAGS);
+      return (i) => c.add(i % 8 + 0.5);
+    }
+  },
+  {
+    name: 'dcounter.lookup',
+    setup: () => () => atlas.dcounter('bench.dcounter', TAGS)
+  },
+  {
+    name: 'dcounter.increment',
+    setup: () => {
+      const c = atlas.dcounter('bench.dcounter', TAGS);
+      return () => c.increment(0.5);
+    }
+  },
+  {
+    name: 'dcounter.add',
+    setup: () => {
+      const c = atlas.dcounter('bench.dcounter', TAGS);
+      return (i) => c.add(i % 8);
+    }
+  },
+  {
+    name: 'intervalCounter.lookup',
+    setup: () => () => atlas.intervalCounter('bench.intervalCounter', TAGS)
+  },
+  {
+    name: 'intervalCounter.increment',
+    setup: () => {
+      const c = atlas.intervalCounter('bench.intervalCounter', TAGS);
+      return () => c.increment();
+    }
+  },
+  {
+    name: 'intervalCounter.add',
+    setup: () => {
+      const c = atlas.intervalCounter('bench.intervalCounter', TAGS);
+      return (i) => c.add(i % 8);
+    }
+  },
+  {
+    name: 'timer.lookup',
+    setup: () => () => atlas.timer('bench.timer', TAGS)
+  },
+  {
+    name: 'timer.record',
+    setup: () => {
+      const t = atlas.timer('bench.timer', TAGS);
+      return (i) => t.record(0, i);
+    }
+  },
+  {
+    name: 'timer.recordHrtime',
+    setup: () => {
+      const t = atlas.timer('bench.timer', TAGS);
+      const elapsed = [0, 1000];
+      return () => t.record(elapsed);
+    }
+  },
+  {
+    // measures the call, the handlers run once the loop is back
+    name: 'timer.timePromise',
+    options: {
+      maxSamples: 1000
+    },
+    setup: () => {
+      const t = atlas.timer('bench.timer', TAGS);
+      const resolved = Promise.resolve();
+      return () => t.timePromise(resolved);
+    }
+  },
+  {
+    name: 'timer.timeAsync',
+    options: {
+      maxSamples: 1000
+    },
+    setup: () => {
+      const t = atlas.timer('bench.timer', TAGS);
+      const resolved = Promise.resolve();
+      return () => t.timeAsync((done) => resolved.then(done));
+    }
+  },
+  {
+    name: 'sampledTimer.lookup',
+    setup: () => () => atlas.sampledTimer('bench.sampledTimer', TAGS, {
+      rate: 100
+    })
+  },
+  {
+    name: 'sampledTimer.record',
+    setup: () => {
+      const t = atlas.sampledTimer('bench.sampledTimer', TAGS, {
+        rate: 100
+      });
+      return (i) => t.record(0, i);
+    }
+  },
+  {
+    name: 'longTaskTimer.lookup',
+    setup: () => () => atlas.longTaskTimer('bench.longTaskTimer', TAGS)
+  },
+  {
+    name: 'longTaskTimer.startStop',
+    setup: () => {
+      const t = atlas.longTaskTimer('bench.longTaskTimer', TAGS);
+      return () => t.stop(t.start());
+    }
+  },
+  {
+    name: 'gauge.lookup',
+    setup: () => () => atlas.gauge('bench.gauge', TAGS)
+  },
+  {
+    name: 'gauge.update',
+    setup: () => {
+      const g = atlas.gauge('bench.gauge', TAGS);
+      return (i) => g.update(i);
+    }
+  },
+  {
+    name: 'gauge.updateDouble',
+    setup: () => {
+      const g = atlas.gauge('bench.gauge', TAGS);
+      return (i) => g.update(i / 3);
+    }
+  },
+  {
+    name: 'maxGauge.lookup',
+    setup: () => () => atlas.maxGauge('bench.maxGauge', TAGS)
+  },
+  {
+    name: 'maxGauge.update',
+    setup: () => {
+      const g = atlas.maxGauge('bench.maxGauge', TAGS);
+      return (i) => g.update(i);
+    }
+  },
+  {
+    name: 'age.lookup',
+    setup: () => () => atlas.age('bench.age', TAGS)
+  },
+  {
+    name: 'age.update',
+    setup: () => {
+      const g = atlas.age('bench.age', TAGS);
+      return () => g.update();
+    }
+  },
+  functionGaugeCase(),
+  {
+    name: 'setLazyGaugeInterval',
+    setup: () => () => atlas.setLazyGaugeInterval(30000)
+  },
+  {
+    name: 'distSummary.lookup',
+    setup: () => () => atlas.distSummary('bench.distSummary', TAGS)
+  },
+  {
+    name: 'distSummary.record',
+    setup: () => {
+      const d = atlas.distSummary('bench.distSummary', TAGS);
+      return (i) => d.record(i);
+    }
+  },
+  {
+    name: 'bucketCounter.create',
+    setup: () => () => atlas.bucketCounter('bench.bucketCounter', TAGS,
+      bucketFunction)
+  },
+  {
+    name: 'bucketCounter.record',
+    setup: () => {
+      const b = atlas.bucketCounter('bench.bucketCounter', TAGS,
+        bucketFunction);
+      return (i) => b.record(i * 1000);
+    }
+  },
+  {
+    name: 'bucketDistSummary.create',
+    setup: () => () => atlas.bucketDistSummary('bench.bucketDistSummary',
+      TAGS, bucketFunction)
+  },
+  {
+    name: 'bucketDistSummary.record',
+    setup: () => {
+      const b = atlas.bucketDistSummary('bench.bucketDistSummary', TAGS,
+        bucketFunction);
+      return (i) => b.record(i * 1000);
+    }
+  },
+  {
+    name: 'bucketTimer.create',
+    setup: () => () => atlas.bucketTimer('bench.bucketTimer', TAGS,
+      bucketFunction)
+  },
+  {
+    name: 'bucketTimer.record',
+    setup: () => {
+      const b = atlas.bucketTimer('bench.bucketTimer', TAGS, bucketFunction);
+      return (i) => b.record(0, i * 1000);
+    }
+  },
+  {
+    name: 'bucketTimer.recordHrtime',
+    setup: () => {
+      const b = atlas.bucketTimer('bench.bucketTimer', TAGS, bucketFunction);
+      const elapsed = [0, 1000];
+      return () => b.record(elapsed);
+    }
+  },
+  {
+    name: 'percentileTimer.create',
+    setup: () => () => atlas.percentileTimer('bench.percentileTimer', TAGS)
+  },
+  {
+    name: 'percentileTimer.record',
+    setup: () => {
+      const t = atlas.percentileTimer('bench.percentileTimer', TAGS);
+      return (i) => t.record(0, i * 1000);
+    }
+  },
+  {
+    name: 'percentileTimer.recordHrtime',
+    setup: () => {
+      const t = atlas.percentileTimer('bench.percentileTimer', TAGS);
+      const elapsed = [0, 1000];
+      return () => t.record(elapsed);
+    }
+  },
+  {
+    name: 'percentileDistSummary.create',
+    setup: () => () => atlas.percentileDistSummary(
+      'bench.percentileDistSummary', TAGS)
+  },
+  {
+    name: 'percentileDistSummary.record',
+    setup: () => {
+      const d = atlas.percentileDistSummary('bench.percentileDistSummary',
+        TAGS);
+      return (i) => d.record(i);
+    }
+  },
+  {
+    name: 'setCardinalityLimit',
+    setup: () => () => atlas.setCardinalityLimit(0)
+  },
+  {
+    name: 'setMeterTtl',
+    setup: () => () => atlas.setMeterTtl(0)
+  },
+  {
+    name: 'setSelfMetrics',
+    setup: () => () => atlas.setSelfMetrics(false)
+  },
+  {
+    name: 'memoryStats',
+    options: {
+      batchSize: 1,
+      maxSamples: 1000
+    },
+    setup: () => () => atlas.memoryStats(20)
+  },
+  {
+    name: 'diagnostics',
+    setup: () => () => atlas.diagnostics()
+  },
+  {
+    name: 'stallStacks',
+    setup: () => () => atlas.stallStacks()
+  },
+  {
+    name: 'startStopWatchdog',
+    options: {
+      batchSize: 1,
+      maxSamples: 200
+    },
+    setup: () => () => {
+      atlas.startWatchdog({
+        thresholdMs: 1000
+      });
+      atlas.stopWatchdog();
+    }
+  },
+  {
+    name: 'startStopCpuProfile',
+    options: {
+      batchSize: 1,
+      maxSamples: 50
+    },
+    setup: () => () => {
+      atlas.startCpuProfile({
+        windowMs: 60000
+      });
+      atlas.stopCpuProfile();
+    }
+  },
+  {
+    name: 'startStopScrapeServer',
+    options: {
+      batchSize: 1,
+      maxSamples: 200
+    },
+    setup: () => () => {
+      atlas.startScrapeServer({
+        port: 0
+      });
+      atlas.stopScrapeServer();
+    }
+  },
+  measurementsCase(1000),
+  cursorCase(1000),
+  measurementsCase(10000),
+  cursorCase(10000),
+  measurementsCase(100000),
+  cursorCase(100000),
+  pushCase(1),
+  pushCase(100),
+  pushCase(1000)
+];
+
+// start, stop and their async versions control the process wide publisher
+// and are not meaningful to run in a loop. readCgroupStats completes on the
+// thread pool, so a loop would only measure queueing it
+const skipped = ['start', 'stop', 'startAsync', 'stopAsync',
+  'readCgroupStats'];
+
+module.exports.cases = cases;
+module.exports.skipped = skipped;
+module.exports.fastCalls = atlas.fastCalls === true;
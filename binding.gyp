@@ -1,4 +1,20 @@
 {
+  'variables': {
+    # build the native benchmarks in bench/native:
+    #   node-gyp configure -- -Datlas_bench=1 && node-gyp build
+    'atlas_bench%': 0,
+    # register V8 fast API calls when node supports them. Disable to compare:
+    #   node-gyp configure -- -Datlas_fast_calls=0 && node-gyp build
+    'atlas_fast_calls%': 1,
+    # link-time optimization of the addon, so the call-through functions in
+    # src/functions.cc and src/utils.cc can be inlined across files
+    'atlas_lto%': 0,
+    # profile-guided optimization: 'generate' builds an instrumented addon
+    # that writes profiles to atlas_pgo_dir, 'use' builds with them. See
+    # scripts/build-pgo.sh
+    'atlas_pgo%': '',
+    'atlas_pgo_dir%': '<(module_root_dir)/build/pgo'
+  },
   'targets': [
   {
     'target_name': 'atlas',
@@ -14,6 +30,40 @@
         'nc/root/include'
         ],
       'conditions': [
+        [ 'atlas_fast_calls==0', {
+          'defines': ['ATLAS_NO_FAST_CALLS']
+        }],
+        [ 'atlas_lto==1', {
+          'cflags': ['-flto'],
+          'ldflags': ['-flto'],
+          'xcode_settings': {
+            'LLVM_LTO': 'YES'
+          }
+        }],
+        [ 'atlas_pgo=="generate"', {
+          'cflags': ['-fprofile-generate=<(atlas_pgo_dir)'],
+          'ldflags': ['-fprofile-generate=<(atlas_pgo_dir)'],
+          'xcode_settings': {
+            'OTHER_CPLUSPLUSFLAGS': ['-fprofile-generate=<(atlas_pgo_dir)'],
+            'OTHER_LDFLAGS': ['-fprofile-generate=<(atlas_pgo_dir)']
+          }
+        }],
+        [ 'atlas_pgo=="use"', {
+          'cflags': [
+            '-fprofile-use=<(atlas_pgo_dir)',
+            '-fprofile-correction',
+            '-Wno-missing-profile'
+          ],
+          'ldflags': ['-fprofile-use=<(atlas_pgo_dir)'],
+          'xcode_settings': {
+            'OTHER_CPLUSPLUSFLAGS': [
+              '-fprofile-use=<(atlas_pgo_dir)/default.profdata'
+            ],
+            'OTHER_LDFLAGS': [
+              '-fprofile-use=<(atlas_pgo_dir)/default.profdata'
+            ]
+          }
+        }],
         [ 'OS=="mac"', {
           'xcode_settings': {
             'OTHER_CPLUSPLUSFLAGS' : ['-stdlib=libc++', '-v', '-std=c++11', '-Wall', '-Wextra', '-Wno-unused-parameter', '-g', '-O2' ],
@@ -37,6 +87,40 @@
       'action': ['node', 'scripts/install-lib.js']
     }]
   },
+  ],
+  'conditions': [
+    [ 'atlas_bench==1', {
+      'targets': [
+      {
+        'target_name': 'atlas_bench',
+        'type': 'executable',
+        'dependencies': ['libatlas'],
+        'sources': [
+          'bench/native/id_bench.cc',
+          'src/id_builder.cc'
+        ],
+        'libraries': [
+          "-L<(module_root_dir)/build/Release/",
+          "-Wl,-rpath,\$$ORIGIN",
+          "-latlasclient"
+        ],
+        'include_dirs' : [
+          'nc/root/include'
+        ],
+        'conditions': [
+          [ 'OS=="mac"', {
+            'xcode_settings': {
+              'OTHER_CPLUSPLUSFLAGS' : ['-stdlib=libc++', '-std=c++11', '-Wall', '-Wextra', '-Wno-unused-parameter', '-O2' ],
+              'OTHER_LDFLAGS': ['-stdlib=libc++'],
+              'MACOSX_DEPLOYMENT_TARGET': '10.12'
+            }
+          }],
+          ['OS=="linux"', {
+            'cflags': ['-std=c++11', '-Wall', '-Wextra', '-Wno-unused-parameter', '-O2' ]
+          }]
+        ]
+      }
+      ]
+    }]
   ]
 }
-
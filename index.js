@@ -24,10 +24,12 @@ try {
   throw loadErr;
 }
 
-let updateInterval = 30000;
 let nodeMetrics;
+// meters created from the manifest given to start, by manifest.meterKey
+let preloadedMeters = new Map();
 
 const path = require('path');
+const manifest = require('./manifest');
 
 atlas.JsTimer.prototype.timeAsync = function(fun) {
   const self = this;
@@ -38,35 +40,48 @@ atlas.JsTimer.prototype.timeAsync = function(fun) {
   return fun(done);
 };
 
-let ageGaugeUpdateValue = function(ageGauge) {
-  let elapsed = ((new Date).getTime() - ageGauge.lastUpdated) / 1000.0;
-  ageGauge.gauge.update(elapsed);
+const cursorDone = {
+  done: true,
+  value: undefined
 };
 
-let AgeGauge = function(name, tags) {
-  this.gauge = atlas.gauge(name, tags);
-  this.lastUpdated = (new Date).getTime();
-  this.gauge.update(0);
-  setInterval(ageGaugeUpdateValue, updateInterval, this);
-};
+function cursorResult(page) {
+  return page.length === 0 ? cursorDone : {
+    done: false,
+    value: page
+  };
+}
 
-AgeGauge.prototype.value = function() {
-  return this.gauge.value();
+// pages of measurements: for (const page of atlas.measurementsCursor(500))
+atlas.JsMeasurementsCursor.prototype[Symbol.iterator] = function() {
+  const self = this;
+  return {
+    next: () => cursorResult(self.next()),
+    return: function() {
+      self.close();
+      return cursorDone;
+    }
+  };
 };
 
-AgeGauge.prototype.update = function(updatedTime) {
-  let t = updatedTime || (new Date).getTime();
-  this.lastUpdated = t;
-  ageGaugeUpdateValue(this);
+// same as above, but yields to the event loop between pages
+atlas.JsMeasurementsCursor.prototype[Symbol.asyncIterator] = function() {
+  const self = this;
+  return {
+    next: () => new Promise((resolve) => {
+      setImmediate(() => resolve(cursorResult(self.next())));
+    }),
+    return: function() {
+      self.close();
+      return Promise.resolve(cursorDone);
+    }
+  };
 };
 
 let started = false;
+let startPromise;
 
-function startAtlas(config) {
-  if (started) {
-    return;
-  }
-
+function startOptions(config) {
   const cfg = config ? config : {};
   // default log dirs
   let logDirs = ['/logs/atlas', path.join(__dirname, 'logs'), '/tmp'];
@@ -90,20 +105,90 @@ function startAtlas(config) {
   const nodeVersion = {
     'nodejs.version': process.version
   };
-  atlas.start({
+  const options = {
     developmentMode: developmentMode,
     logDirs: logDirs,
     runtimeMetrics: runtimeMetrics,
     runtimeTags: nodeVersion
-  });
+  };
+
+  // {port: 9090} or {path: '/run/atlas.sock'}
+  if ('scrape' in cfg) {
+    options.scrape = cfg.scrape;
+  }
+
+  // {thresholdMs: 1000, captureStacks: true}
+  if ('stallWatchdog' in cfg) {
+    options.stallWatchdog = cfg.stallWatchdog;
+  }
+
+  // where cgroup files are mounted, for containers that move it
+  if ('cgroupRoot' in cfg) {
+    options.cgroupRoot = cfg.cgroupRoot;
+  }
+
+  // {intervalUs: 10000, windowMs: 60000, topN: 20}, needs runtimeMetrics
+  if ('cpuProfile' in cfg) {
+    options.cpuProfile = cfg.cpuProfile;
+  }
+
+  // distinct tag combinations allowed per metric name
+  if ('cardinalityLimit' in cfg) {
+    options.cardinalityLimit = cfg.cardinalityLimit;
+  }
+
+  // meters not used for this long release their native memory
+  if ('meterTtlMs' in cfg) {
+    options.meterTtlMs = cfg.meterTtlMs;
+  }
 
-  if (runtimeMetrics) {
+  // true, or N to time 1 in N calls
+  if ('selfMetrics' in cfg) {
+    options.selfMetrics = cfg.selfMetrics;
+  }
+  return options;
+}
+
+function startNodeMetrics(options) {
+  if (options.runtimeMetrics) {
     const nm = require('./node-metrics');
-    nodeMetrics = new nm.NodeMetrics(atlas, nodeVersion);
+    nodeMetrics = new nm.NodeMetrics(atlas, options.runtimeTags);
     nodeMetrics.start();
   }
+}
+
+function loadManifest(config) {
+  return config && config.manifest ? manifest.load(config.manifest) : [];
+}
+
+function startAtlas(config) {
+  if (started) {
+    return;
+  }
+
+  const options = startOptions(config);
+  const entries = loadManifest(config);
+  atlas.start(options);
+  preloadedMeters = manifest.preload(module.exports, entries);
+  startNodeMetrics(options);
+  started = true;
+}
+
+// same as startAtlas, but loads the config and starts the publisher off the
+// event loop. Meters can be used right away, the promise resolves once
+// publishing has started
+function startAtlasAsync(config) {
+  if (started) {
+    return startPromise || Promise.resolve();
+  }
 
+  const options = startOptions(config);
+  const entries = loadManifest(config);
+  startPromise = new Promise((resolve) => atlas.startAsync(options, resolve));
+  preloadedMeters = manifest.preload(module.exports, entries);
+  startNodeMetrics(options);
   started = true;
+  return startPromise;
 }
 
 function stopAtlas() {
@@ -117,6 +202,23 @@ function stopAtlas() {
   }
   atlas.stop();
   started = false;
+  startPromise = undefined;
+}
+
+// same as stopAtlas, but the final flush runs on a background thread for at
+// most options.deadlineMs. Resolves with {timedOut}
+function stopAtlasAsync(options) {
+  if (!started) {
+    return Promise.resolve({timedOut: false});
+  }
+
+  if (nodeMetrics) {
+    nodeMetrics.stop();
+    nodeMetrics = undefined;
+  }
+  started = false;
+  startPromise = undefined;
+  return new Promise((resolve) => atlas.stopAsync(options || {}, resolve));
 }
 
 function debugInfo() {
@@ -151,8 +253,12 @@ let scope = function(commonTags) {
 
   let s = {
     start: startAtlas,
+    startAsync: startAtlasAsync,
+    stopAsync: stopAtlasAsync,
     stop: stopAtlas,
     setDevMode: devMode,
+    setCardinalityLimit: (limit) => atlas.setCardinalityLimit(limit),
+    setMeterTtl: (millis) => atlas.setMeterTtl(millis),
     getDebugInfo: debugInfo,
     validateNameAndTags: validateNameAndTags,
     counter: (name, tags) => atlas.counter(
@@ -163,6 +269,9 @@ let scope = function(commonTags) {
       name, Object.assign({}, commonTags, tags)),
     timer: (name, tags) => atlas.timer(
       name, Object.assign({}, commonTags, tags)),
+    // sampledTimer(name, tags, {rate: 100}) records 1 in 100 events
+    sampledTimer: (name, tags, options) => atlas.sampledTimer(
+      name, Object.assign({}, commonTags, tags), options),
     gauge: (name, tags) => atlas.gauge(
       name, Object.assign({}, commonTags, tags)),
     maxGauge: (name, tags) => atlas.maxGauge(
@@ -175,8 +284,16 @@ let scope = function(commonTags) {
       name, Object.assign({}, commonTags, tags)),
     percentileTimer: (name, tags) => atlas.percentileTimer(
       name, Object.assign({}, commonTags, tags)),
-    age: (name, tags) => new AgeGauge(
+    age: (name, tags) => atlas.age(
       name, Object.assign({}, commonTags, tags)),
+    // functionGauge(name, [tags], fn): fn is only called when a snapshot
+    // of the registry is taken
+    functionGauge: function(name, tags, fn) {
+      const userTags = typeof tags === 'function' ? {} : tags;
+      const valueFn = typeof tags === 'function' ? tags : fn;
+      return atlas.functionGauge(
+        name, Object.assign({}, commonTags, userTags), valueFn);
+    },
     bucketCounter: function() {
       let args = bucketArgs.apply(this, arguments);
       return atlas.bucketCounter(args[0], args[1], args[2]);
@@ -189,7 +306,20 @@ let scope = function(commonTags) {
       let args = bucketArgs.apply(this, arguments);
       return atlas.bucketTimer(args[0], args[1], args[2]);
     },
+    // a meter created from the manifest given to start, or undefined. The
+    // manifest is preloaded through the root scope, so meters are keyed by
+    // their full id and this scope's common tags are part of the lookup
+    preloaded: (name, tags) => preloadedMeters.get(
+      manifest.meterKey(name, Object.assign({}, commonTags, tags))),
     measurements: () => atlas.measurements(),
+    measurementsCursor: (pageSize) => atlas.measurementsCursor(pageSize),
+    memoryStats: (topN) => atlas.memoryStats(topN),
+    startWatchdog: (options) => atlas.startWatchdog(options),
+    stopWatchdog: () => atlas.stopWatchdog(),
+    stallStacks: () => atlas.stallStacks(),
+    startCpuProfile: (options) => atlas.startCpuProfile(options),
+    stopCpuProfile: () => atlas.stopCpuProfile(),
+    diagnostics: () => atlas.diagnostics(),
     // used by the old prana interface. Should not be used by new code.
     // sends metrics immediately to atlas, they're not available for alerts/cloudwatch/etc.
     push: (metrics) => atlas.push(metrics),
@@ -197,7 +327,7 @@ let scope = function(commonTags) {
     scope: tags => scope(Object.assign({}, commonTags, tags)),
     // for testing
     setUpdateInterval: function(newInterval) {
-      updateInterval = newInterval;
+      atlas.setLazyGaugeInterval(newInterval);
     }
   };
 
@@ -0,0 +1,113 @@
+'use strict';
+
+// Meter manifests list the meters an application is going to use, so they
+// can be registered at startup instead of on the first request:
+//
+// {
+//   "meters": [
+//     {"name": "server.requestCount", "type": "counter",
+//      "tags": {"status": ["200", "404", "500"], "method": ["GET", "POST"]}},
+//     {"name": "server.requestLatency", "type": "bucketTimer",
+//      "bucket": {"function": "latency", "value": 8, "unit": "s"}},
+//     {"name": "db.queryTime", "type": "sampledTimer", "options": {"rate": 10}}
+//   ]
+// }
+//
+// Each tag lists its known values, one meter is created for every
+// combination of them.
+
+const fs = require('fs');
+
+const TYPES = new Set(['counter', 'dcounter', 'intervalCounter', 'timer',
+  'sampledTimer', 'gauge', 'maxGauge', 'distSummary', 'longTaskTimer',
+  'percentileTimer', 'percentileDistSummary', 'age', 'bucketCounter',
+  'bucketDistSummary', 'bucketTimer']);
+
+// protects against a manifest that would create an unbounded number of
+// meters for a single entry
+const MAX_COMBINATIONS = 10000;
+
+function meterKey(name, tags) {
+  const keys = Object.keys(tags).sort();
+  return `${name}|${keys.map((k) => `${k}=${tags[k]}`).join(',')}`;
+}
+module.exports.meterKey = meterKey;
+
+// number of meters an entry expands to, computed without expanding it
+function countCombinations(tags) {
+  return Object.keys(tags || {}).reduce((n, key) =>
+    n * [].concat(tags[key]).length, 1);
+}
+
+// all combinations of the known values of each tag
+function tagCombinations(tags) {
+  let combinations = [{}];
+
+  for (const key of Object.keys(tags || {})) {
+    const values = [].concat(tags[key]).map(String);
+    const next = [];
+
+    for (const combination of combinations) {
+      for (const value of values) {
+        const c = Object.assign({}, combination);
+        c[key] = value;
+        next.push(c);
+      }
+    }
+    combinations = next;
+  }
+  return combinations;
+}
+module.exports._tagCombinations = tagCombinations;
+
+function validate(entry, idx) {
+  const where = `meter manifest entry ${idx}`;
+
+  if (typeof entry.name !== 'string' || entry.name.length === 0) {
+    throw new Error(`${where}: name is required`);
+  }
+
+  if (!TYPES.has(entry.type)) {
+    throw new Error(`${where}: unknown type ${entry.type}`);
+  }
+
+  if (entry.type.startsWith('bucket') && typeof entry.bucket !== 'object') {
+    throw new Error(`${where}: ${entry.type} needs a bucket function`);
+  }
+
+  const count = countCombinations(entry.tags);
+
+  if (count > MAX_COMBINATIONS) {
+    throw new Error(`${where}: ${count} tag combinations exceed the limit ` +
+      `of ${MAX_COMBINATIONS}`);
+  }
+}
+
+// parse a manifest file, throwing on entries that cannot be preloaded
+function load(file) {
+  const manifest = JSON.parse(fs.readFileSync(file, 'utf8'));
+  const entries = manifest.meters || [];
+  entries.forEach(validate);
+  return entries;
+}
+module.exports.load = load;
+
+// create every meter in entries using api, returning a map from meterKey to
+// meter
+function preload(api, entries) {
+  const meters = new Map();
+
+  entries.forEach(validate);
+  entries.forEach((entry) => {
+    const combinations = tagCombinations(entry.tags);
+    const extra = entry.type.startsWith('bucket') ? entry.bucket :
+      entry.options;
+
+    for (const tags of combinations) {
+      meters.set(meterKey(entry.name, tags),
+        api[entry.type](entry.name, tags, extra));
+    }
+  });
+  return meters;
+}
+module.exports.preload = preload;
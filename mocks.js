@@ -10,6 +10,8 @@ function atlas() {
   const intervalCounterIncrement = sinon.spy();
   const timer = sinon.stub();
   const timerRecord = sinon.spy();
+  const sampledTimer = sinon.stub();
+  const sampledTimerRecord = sinon.spy();
   const maxGauge = sinon.stub();
   const maxGaugeUpdate = sinon.spy();
   const gauge = sinon.stub();
@@ -24,6 +26,8 @@ function atlas() {
   const percentileTimerRecord = sinon.spy();
   const age = sinon.stub();
   const ageUpdate = sinon.spy();
+  const functionGauge = sinon.stub();
+  const functionGaugeValue = sinon.spy();
   const bucketCounter = sinon.stub();
   const bucketCounterRecord = sinon.spy();
   const bucketDistSummary = sinon.stub();
@@ -32,19 +36,39 @@ function atlas() {
   const bucketTimerRecord = sinon.spy();
   const getDebugInfo = sinon.spy();
   const start = sinon.spy();
+  const startAsync = sinon.stub();
   const stop = sinon.spy();
+  const stopAsync = sinon.stub();
   const config = sinon.spy();
   const measurements = sinon.spy();
+  const measurementsCursor = sinon.stub();
+  const memoryStats = sinon.stub();
   const push = sinon.spy();
+  // no recent activity
+  const rollingWindow = () => ({
+    rate: () => 0,
+    mean: () => NaN,
+    percentile: () => NaN,
+    count: () => 0
+  });
   const apiExceptScope = {
     counter: counter.returns({
-      increment: counterIncrement
+      increment: counterIncrement,
+      rollingWindow: rollingWindow
     }),
     intervalCounter: intervalCounter.returns({
       increment: intervalCounterIncrement
     }),
     timer: timer.returns({
-      record: timerRecord
+      record: timerRecord,
+      timePromise: (p) => p,
+      rollingWindow: rollingWindow
+    }),
+    sampledTimer: sampledTimer.returns({
+      record: sampledTimerRecord,
+      start: () => 0,
+      stop: () => undefined,
+      timeThis: (fn) => fn()
     }),
     gauge: gauge.returns({
       update: gaugeUpdate
@@ -62,11 +86,16 @@ function atlas() {
       record: percentileDistSummaryRecord
     }),
     percentileTimer: percentileTimer.returns({
-      record: percentileTimerRecord
+      record: percentileTimerRecord,
+      timePromise: (p) => p,
+      rollingWindow: rollingWindow
     }),
     age: age.returns({
       update: ageUpdate
     }),
+    functionGauge: functionGauge.returns({
+      value: functionGaugeValue
+    }),
     bucketCounter: bucketCounter.returns({
       record: bucketCounterRecord
     }),
@@ -74,13 +103,31 @@ function atlas() {
       record: bucketDistSummaryRecord
     }),
     bucketTimer: bucketTimer.returns({
-      record: bucketTimerRecord
+      record: bucketTimerRecord,
+      timePromise: (p) => p
     }),
     getDebugInfo: getDebugInfo,
     start: start,
+    startAsync: startAsync.resolves(),
     stop: stop,
+    stopAsync: stopAsync.resolves({timedOut: false}),
     config: config,
     measurements: measurements,
+    measurementsCursor: measurementsCursor.returns({
+      next: () => [],
+      done: () => true,
+      size: () => 0,
+      close: () => undefined
+    }),
+    preloaded: () => undefined,
+    stallStacks: () => [],
+    diagnostics: () => ({invalidIds: []}),
+    memoryStats: memoryStats.returns({
+      totalBytes: 0,
+      strings: {count: 0, bytes: 0},
+      types: {},
+      names: []
+    }),
     push: push
   };
   const scope = sinon.stub();
@@ -92,6 +139,8 @@ function atlas() {
       intervalCounterIncrement: intervalCounterIncrement,
       timer: timer,
       timerRecord: timerRecord,
+      sampledTimer: sampledTimer,
+      sampledTimerRecord: sampledTimerRecord,
       gauge: gauge,
       gaugeUpdate: gaugeUpdate,
       maxGauge: maxGauge,
@@ -106,6 +155,8 @@ function atlas() {
       percentileTimerRecord: percentileTimerRecord,
       age: age,
       ageUpdate: ageUpdate,
+      functionGauge: functionGauge,
+      functionGaugeValue: functionGaugeValue,
       bucketCounter: bucketCounter,
       bucketCounterRecord: bucketCounterRecord,
       bucketDistSummary: bucketDistSummary,
@@ -114,7 +165,9 @@ function atlas() {
       bucketTimerRecord: bucketTimerRecord,
       getDebugInfo: getDebugInfo,
       start: start,
+      startAsync: startAsync,
       stop: stop,
+      stopAsync: stopAsync,
       config: config,
       scope: scope
     };
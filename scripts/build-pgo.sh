@@ -0,0 +1,57 @@
+#!/bin/sh
+#
+# Builds the addon with link-time and profile-guided optimization:
+#
+#   1. an instrumented build (-Datlas_pgo=generate)
+#   2. a training run: bench/replay.js replays test/metrics-test.txt as fast
+#      as it can, which exercises the same calls an instrumented service makes.
+#      It publishes to a local bench/fake-atlas.js server, never to the
+#      configured backend
+#   3. the optimized build (-Datlas_pgo=use), which stays in build/Release
+#
+#   scripts/build-pgo.sh            # build only
+#   scripts/build-pgo.sh --compare  # also benchmark it against the default
+#                                   # build and print the comparison
+#
+# PGO_TRAIN_SECONDS sets the length of the training run (default 30). The
+# profiles and the benchmark reports are kept in build/pgo.
+
+set -e
+
+cd "$(dirname "$0")/.."
+ROOT=$(pwd)
+PGO_DIR="$ROOT/build/pgo"
+NODE_GYP="$ROOT/node_modules/.bin/node-gyp"
+TRAIN_SECONDS=${PGO_TRAIN_SECONDS:-30}
+
+build() {
+  "$NODE_GYP" configure -- "$@"
+  "$NODE_GYP" build
+}
+
+rm -rf "$PGO_DIR"
+mkdir -p "$PGO_DIR"
+
+if [ "$1" = "--compare" ]; then
+  build
+  npm run bench -- --out "$PGO_DIR/default.json"
+fi
+
+build -Datlas_lto=1 -Datlas_pgo=generate -Datlas_pgo_dir="$PGO_DIR"
+# no --publish: the training metrics go to replay's fake server
+node bench/replay.js --rate 0 --duration "$TRAIN_SECONDS" > "$PGO_DIR/train.json"
+
+# clang writes raw profiles that have to be merged first
+if [ "$(uname)" = "Darwin" ]; then
+  xcrun llvm-profdata merge -output="$PGO_DIR/default.profdata" \
+    "$PGO_DIR"/*.profraw
+fi
+
+build -Datlas_lto=1 -Datlas_pgo=use -Datlas_pgo_dir="$PGO_DIR"
+
+if [ "$1" = "--compare" ]; then
+  npm run bench -- --out "$PGO_DIR/pgo.json"
+  # a threshold of 100 only reports, a slower PGO build is not an error here
+  node bench/compare.js "$PGO_DIR/default.json" "$PGO_DIR/pgo.json" 100 \
+    | tee "$PGO_DIR/report.txt"
+fi
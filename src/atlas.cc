@@ -1,6 +1,15 @@
 #include "atlas.h"
 #include "start_stop.h"
+#include "cgroup.h"
+#include "cpu_profile.h"
+#include "diagnostics.h"
 #include "functions.h"
+#include "js_meter.h"
+#include "memory_stats.h"
+#include "rolling_window.h"
+#include "scrape_server.h"
+#include "self_metrics.h"
+#include "watchdog.h"
 
 using Nan::GetFunction;
 using Nan::New;
@@ -10,9 +19,11 @@ using v8::FunctionTemplate;
 // atlas.cc represents the top level of the module.
 // C++ constructs that are exposed to javascript are exported here
 
+// never destroyed: a stopAsync() flush thread may still be using it while
+// the process exits
 atlas::Client& atlas_client() {
-  static atlas::Client client;
-  return client;
+  static auto client = new atlas::Client();
+  return *client;
 }
 
 atlas::meter::Registry* atlas_registry() {
@@ -23,9 +34,45 @@ NAN_MODULE_INIT(InitAll) {
   Set(target, New("start").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(start)).ToLocalChecked());
 
+  Set(target, New("startAsync").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(start_async)).ToLocalChecked());
+
   Set(target, New("stop").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(stop)).ToLocalChecked());
 
+  Set(target, New("stopAsync").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(stop_async)).ToLocalChecked());
+
+  Set(target, New("startWatchdog").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(start_watchdog)).ToLocalChecked());
+
+  Set(target, New("stopWatchdog").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(stop_watchdog)).ToLocalChecked());
+
+  Set(target, New("startCpuProfile").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(start_cpu_profile)).ToLocalChecked());
+
+  Set(target, New("stopCpuProfile").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(stop_cpu_profile)).ToLocalChecked());
+
+  Set(target, New("stallStacks").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(stall_stacks)).ToLocalChecked());
+
+  Set(target, New("diagnostics").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(diagnostics)).ToLocalChecked());
+
+  Set(target, New("readCgroupStats").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(read_cgroup_stats)).ToLocalChecked());
+
+  // whether increment/update/record have fast API overloads in this build
+  Set(target, New("fastCalls").ToLocalChecked(), New(kFastCalls));
+
+  Set(target, New("startScrapeServer").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(start_scrape)).ToLocalChecked());
+
+  Set(target, New("stopScrapeServer").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(stop_scrape)).ToLocalChecked());
+
   Set(target, New("counter").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(counter)).ToLocalChecked());
 
@@ -38,6 +85,9 @@ NAN_MODULE_INIT(InitAll) {
   Set(target, New("timer").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(timer)).ToLocalChecked());
 
+  Set(target, New("sampledTimer").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(sampled_timer)).ToLocalChecked());
+
   Set(target, New("longTaskTimer").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(long_task_timer)).ToLocalChecked());
 
@@ -47,6 +97,16 @@ NAN_MODULE_INIT(InitAll) {
   Set(target, New("maxGauge").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(max_gauge)).ToLocalChecked());
 
+  Set(target, New("age").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(age_gauge)).ToLocalChecked());
+
+  Set(target, New("functionGauge").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(function_gauge)).ToLocalChecked());
+
+  Set(target, New("setLazyGaugeInterval").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(set_lazy_gauge_interval))
+          .ToLocalChecked());
+
   Set(target, New("distSummary").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(dist_summary)).ToLocalChecked());
 
@@ -69,6 +129,12 @@ NAN_MODULE_INIT(InitAll) {
   Set(target, New("measurements").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(measurements)).ToLocalChecked());
 
+  Set(target, New("measurementsCursor").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(measurements_cursor)).ToLocalChecked());
+
+  Set(target, New("memoryStats").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(memory_stats)).ToLocalChecked());
+
   Set(target, New("config").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(config)).ToLocalChecked());
 
@@ -78,6 +144,16 @@ NAN_MODULE_INIT(InitAll) {
   Set(target, New("setDevMode").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(set_dev_mode)).ToLocalChecked());
 
+  Set(target, New("setCardinalityLimit").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(set_cardinality_limit))
+          .ToLocalChecked());
+
+  Set(target, New("setMeterTtl").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(set_meter_ttl)).ToLocalChecked());
+
+  Set(target, New("setSelfMetrics").ToLocalChecked(),
+      GetFunction(New<FunctionTemplate>(set_self_metrics)).ToLocalChecked());
+
   Set(target, New("validateNameAndTags").ToLocalChecked(),
       GetFunction(New<FunctionTemplate>(validate_name_tags)).ToLocalChecked());
 
@@ -85,15 +161,20 @@ NAN_MODULE_INIT(InitAll) {
   JsDCounter::Init(target);
   JsIntervalCounter::Init(target);
   JsTimer::Init(target);
+  JsSampledTimer::Init(target);
   JsLongTaskTimer::Init(target);
   JsGauge::Init(target);
   JsMaxGauge::Init(target);
+  JsAgeGauge::Init(target);
+  JsFunctionGauge::Init(target);
   JsDistSummary::Init(target);
   JsBucketCounter::Init(target);
   JsBucketDistSummary::Init(target);
   JsBucketTimer::Init(target);
   JsPercentileTimer::Init(target);
   JsPercentileDistSummary::Init(target);
+  JsMeasurementsCursor::Init(target);
+  JsRollingWindow::Init(target);
 }
 
 NODE_MODULE(Atlas, InitAll)
@@ -0,0 +1,55 @@
+#include "cardinality.h"
+
+// keys and values are interned, so their addresses identify them
+static uint64_t mix(uint64_t h) noexcept {
+  // finalizer from murmur3
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+uint64_t tags_hash(const atlas::meter::Tags& tags) noexcept {
+  uint64_t h = 0;
+  for (const auto& kv : tags) {
+    auto k = reinterpret_cast<uintptr_t>(kv.first.get());
+    auto v = reinterpret_cast<uintptr_t>(kv.second.get());
+    // addition is commutative, so the order of the tags does not matter
+    h += mix(mix(k) ^ v);
+  }
+  return h;
+}
+
+void SeriesTracker::SetLimit(size_t limit) noexcept {
+  limit_ = limit;
+  if (limit_ == 0) {
+    series_.clear();
+  }
+}
+
+bool SeriesTracker::Admit(const char* name, const atlas::meter::Tags& tags) {
+  if (limit_ == 0) {
+    return true;
+  }
+  auto& seen = series_[name];
+  auto h = tags_hash(tags);
+  if (seen.size() < limit_) {
+    seen.insert(h);
+    return true;
+  }
+  return seen.find(h) != seen.end();
+}
+
+void SeriesTracker::Forget(const char* name, uint64_t tags_hash) {
+  auto it = series_.find(name);
+  if (it != series_.end()) {
+    it->second.erase(tags_hash);
+  }
+}
+
+size_t SeriesTracker::Size(const char* name) const noexcept {
+  auto it = series_.find(name);
+  return it == series_.end() ? 0 : it->second.size();
+}
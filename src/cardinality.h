@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atlas/meter/id.h>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+// tracks the distinct tag combinations seen for each metric name, so a tag
+// with unbounded values cannot create an unbounded number of ids
+class SeriesTracker {
+ public:
+  // 0 means no limit, and nothing is tracked
+  void SetLimit(size_t limit) noexcept;
+  size_t Limit() const noexcept { return limit_; }
+
+  // whether name and tags were seen before or there is still room for
+  // them. name must be interned
+  bool Admit(const char* name, const atlas::meter::Tags& tags);
+
+  // stop tracking a tag combination, making room for a new one
+  void Forget(const char* name, uint64_t tags_hash);
+
+  // number of distinct tag combinations tracked for name
+  size_t Size(const char* name) const noexcept;
+
+ private:
+  size_t limit_ = 0;
+  std::unordered_map<const char*, std::unordered_set<uint64_t>> series_;
+};
+
+// hash of a set of interned tags that does not depend on their order
+uint64_t tags_hash(const atlas::meter::Tags& tags) noexcept;
@@ -0,0 +1,363 @@
+#include "cgroup.h"
+#include "atlas.h"
+#include "self_metrics.h"
+#include "start_stop.h"
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <sys/stat.h>
+
+using atlas::meter::Tag;
+
+static constexpr unsigned int CGROUP_PERIOD_MS = 10 * 1000;
+static constexpr const char* kSelfCgroup = "/proc/self/cgroup";
+// cgroup v1 reports no limit as a huge page aligned number
+static constexpr double kV1Unlimited = 4611686018427387904.0;  // 2^62
+
+static bool file_exists(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0;
+}
+
+// first line of a file, empty if it cannot be read
+static std::string read_line(const std::string& path) {
+  std::ifstream in{path};
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+static bool read_number(const std::string& path, double* value) {
+  auto line = read_line(path);
+  if (line.empty()) {
+    return false;
+  }
+  if (line == "max") {
+    *value = -1;
+    return true;
+  }
+  char* end;
+  *value = strtod(line.c_str(), &end);
+  return end != line.c_str();
+}
+
+// cpu.stat has one "key value" pair per line
+static bool read_cpu_stat(const std::string& path, const char* throttled_key,
+                          uint64_t throttled_divisor, CgroupStats* stats) {
+  std::ifstream in{path};
+  if (!in) {
+    return false;
+  }
+  std::string key;
+  uint64_t value;
+  while (in >> key >> value) {
+    if (key == "nr_periods") {
+      stats->nr_periods = value;
+    } else if (key == "nr_throttled") {
+      stats->nr_throttled = value;
+    } else if (key == throttled_key) {
+      stats->throttled_us = value / throttled_divisor;
+    }
+  }
+  stats->has_cpu = true;
+  return true;
+}
+
+// "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+static void parse_pressure_line(const std::string& line,
+                                CgroupPressure* pressure) {
+  std::istringstream in{line};
+  std::string field;
+  while (in >> field) {
+    auto eq = field.find('=');
+    if (eq == std::string::npos) {
+      continue;
+    }
+    auto name = field.substr(0, eq);
+    auto value = field.c_str() + eq + 1;
+    if (name == "avg10") {
+      pressure->avg10 = strtod(value, nullptr);
+    } else if (name == "total") {
+      pressure->total_us = strtoull(value, nullptr, 10);
+    }
+  }
+}
+
+static void read_pressure(const std::string& path, CgroupStats* stats) {
+  std::ifstream in{path};
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 5, "some ") == 0) {
+      parse_pressure_line(line, &stats->memory_some);
+      stats->has_pressure = true;
+    } else if (line.compare(0, 5, "full ") == 0) {
+      parse_pressure_line(line, &stats->memory_full);
+      stats->has_pressure = true;
+    }
+  }
+}
+
+// the cgroup v2 directory of the process: the path of the "0::/path" line
+// of self_cgroup under root. root itself when there is no such line or the
+// path is not there, as in a container with its own cgroup namespace
+static std::string v2_dir(const std::string& root,
+                          const std::string& self_cgroup) {
+  std::ifstream in{self_cgroup};
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 3, "0::") != 0) {
+      continue;
+    }
+    auto path = line.substr(3);
+    if (path.empty() || path == "/") {
+      return root;
+    }
+    auto dir = root + path;
+    return file_exists(dir + "/cgroup.controllers") ? dir : root;
+  }
+  return root;
+}
+
+static void read_v2(const std::string& root, CgroupStats* stats) {
+  stats->version = 2;
+  read_cpu_stat(root + "/cpu.stat", "throttled_usec", 1, stats);
+  if (read_number(root + "/memory.current", &stats->memory_usage)) {
+    stats->has_memory = true;
+    read_number(root + "/memory.max", &stats->memory_limit);
+  }
+  read_pressure(root + "/memory.pressure", stats);
+}
+
+static void read_v1(const std::string& root, CgroupStats* stats) {
+  for (auto dir : {"/cpu", "/cpu,cpuacct", "/cpuacct,cpu"}) {
+    // throttled_time is in nanoseconds
+    if (read_cpu_stat(root + dir + "/cpu.stat", "throttled_time", 1000,
+                      stats)) {
+      break;
+    }
+  }
+  auto memory = root + "/memory";
+  if (read_number(memory + "/memory.usage_in_bytes", &stats->memory_usage)) {
+    stats->has_memory = true;
+    double limit;
+    if (read_number(memory + "/memory.limit_in_bytes", &limit) &&
+        limit < kV1Unlimited) {
+      stats->memory_limit = limit;
+    }
+  }
+  if (stats->has_cpu || stats->has_memory) {
+    stats->version = 1;
+  }
+}
+
+CgroupStats read_cgroup_stats(const std::string& root,
+                              const std::string& self_cgroup) {
+  CgroupStats stats;
+  if (file_exists(root + "/cgroup.controllers")) {
+    read_v2(v2_dir(root, self_cgroup), &stats);
+  } else {
+    read_v1(root, &stats);
+  }
+  return stats;
+}
+
+static uv_timer_t cgroup_timer;
+static bool cgroup_timer_initialized = false;
+static bool sampler_running = false;
+static bool sample_in_flight = false;
+// bumped on every start so a sample from a previous run is ignored
+static uint64_t sampler_generation = 0;
+static std::string sampler_root;
+static CgroupStats prev_stats;
+static bool has_prev_stats = false;
+
+struct CgroupWork {
+  uv_work_t req;
+  uint64_t generation;
+  std::string root;
+  CgroupStats stats;
+};
+
+// counters in the cgroup files only go up, unless the cgroup was replaced
+static uint64_t delta(uint64_t current, uint64_t previous) {
+  return current >= previous ? current - previous : 0;
+}
+
+static void publish_pressure(const char* kind, const CgroupPressure& current,
+                             const CgroupPressure& previous, bool has_prev) {
+  auto r = atlas_registry();
+  auto kind_tag = Tag::of("id", kind);
+  r->gauge(node_id("nodejs.cgroup.memory.pressure")->WithTag(kind_tag))
+      ->Update(current.avg10);
+  if (has_prev) {
+    r->dcounter(node_id("nodejs.cgroup.memory.stallTime")->WithTag(kind_tag))
+        ->Add(delta(current.total_us, previous.total_us) / 1e6);
+  }
+}
+
+static void publish(const CgroupStats& stats) {
+  auto r = atlas_registry();
+  if (stats.has_cpu && has_prev_stats && prev_stats.has_cpu) {
+    r->counter(node_id("nodejs.cgroup.cpu.periods"))
+        ->Add(delta(stats.nr_periods, prev_stats.nr_periods));
+    r->counter(node_id("nodejs.cgroup.cpu.throttledPeriods"))
+        ->Add(delta(stats.nr_throttled, prev_stats.nr_throttled));
+    r->dcounter(node_id("nodejs.cgroup.cpu.throttledTime"))
+        ->Add(delta(stats.throttled_us, prev_stats.throttled_us) / 1e6);
+  }
+
+  if (stats.has_memory) {
+    r->gauge(node_id("nodejs.cgroup.memory.usage"))->Update(stats.memory_usage);
+    if (stats.memory_limit >= 0) {
+      r->gauge(node_id("nodejs.cgroup.memory.limit"))
+          ->Update(stats.memory_limit);
+    }
+  }
+
+  if (stats.has_pressure) {
+    auto has_prev = has_prev_stats && prev_stats.has_pressure;
+    publish_pressure("some", stats.memory_some, prev_stats.memory_some,
+                     has_prev);
+    publish_pressure("full", stats.memory_full, prev_stats.memory_full,
+                     has_prev);
+  }
+
+  prev_stats = stats;
+  has_prev_stats = true;
+}
+
+static void sample_cgroup(uv_work_t* req) {
+  auto work = static_cast<CgroupWork*>(req->data);
+  work->stats = read_cgroup_stats(work->root, kSelfCgroup);
+}
+
+static void after_sample_cgroup(uv_work_t* req, int status) {
+  std::unique_ptr<CgroupWork> work{static_cast<CgroupWork*>(req->data)};
+  sample_in_flight = false;
+  if (status != 0 || !sampler_running ||
+      work->generation != sampler_generation) {
+    return;
+  }
+  SelfTimer self_timer{SelfOp::kSampler};
+  publish(work->stats);
+}
+
+static void on_cgroup_timer(uv_timer_t*) {
+  // a slow filesystem should not pile up reads on the thread pool
+  if (sample_in_flight) {
+    return;
+  }
+  auto work = new CgroupWork;
+  work->req.data = work;
+  work->generation = sampler_generation;
+  work->root = sampler_root;
+  sample_in_flight = true;
+  uv_queue_work(uv_default_loop(), &work->req, sample_cgroup,
+                after_sample_cgroup);
+}
+
+void start_cgroup_sampler(const std::string& root) {
+  stop_cgroup_sampler();
+
+  sampler_root = root;
+  ++sampler_generation;
+  has_prev_stats = false;
+  if (!cgroup_timer_initialized) {
+    uv_timer_init(uv_default_loop(), &cgroup_timer);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&cgroup_timer));
+    cgroup_timer_initialized = true;
+  }
+  // the first sample only sets the baseline for the counters
+  uv_timer_start(&cgroup_timer, on_cgroup_timer, 0, CGROUP_PERIOD_MS);
+  sampler_running = true;
+}
+
+void stop_cgroup_sampler() {
+  if (!sampler_running) {
+    return;
+  }
+  uv_timer_stop(&cgroup_timer);
+  sampler_running = false;
+}
+
+static v8::Local<v8::Object> pressure_to_object(
+    const CgroupPressure& pressure) {
+  auto result = Nan::New<v8::Object>();
+  Nan::Set(result, Nan::New("avg10").ToLocalChecked(),
+           Nan::New(pressure.avg10));
+  Nan::Set(result, Nan::New("total").ToLocalChecked(),
+           Nan::New(static_cast<double>(pressure.total_us)));
+  return result;
+}
+
+static v8::Local<v8::Object> stats_to_object(const CgroupStats& stats) {
+  auto result = Nan::New<v8::Object>();
+  auto set = [&result](const char* key, v8::Local<v8::Value> value) {
+    Nan::Set(result, Nan::New(key).ToLocalChecked(), value);
+  };
+  set("version", Nan::New(stats.version));
+  if (stats.has_cpu) {
+    set("periods", Nan::New(static_cast<double>(stats.nr_periods)));
+    set("throttledPeriods", Nan::New(static_cast<double>(stats.nr_throttled)));
+    set("throttledUsec", Nan::New(static_cast<double>(stats.throttled_us)));
+  }
+  if (stats.has_memory) {
+    set("memoryUsage", Nan::New(stats.memory_usage));
+    if (stats.memory_limit >= 0) {
+      set("memoryLimit", Nan::New(stats.memory_limit));
+    }
+  }
+  if (stats.has_pressure) {
+    auto pressure = Nan::New<v8::Object>();
+    Nan::Set(pressure, Nan::New("some").ToLocalChecked(),
+             pressure_to_object(stats.memory_some));
+    Nan::Set(pressure, Nan::New("full").ToLocalChecked(),
+             pressure_to_object(stats.memory_full));
+    set("memoryPressure", pressure);
+  }
+  return result;
+}
+
+class CgroupWorker : public Nan::AsyncWorker {
+ public:
+  CgroupWorker(Nan::Callback* callback, std::string root,
+               std::string self_cgroup)
+      : Nan::AsyncWorker{callback, "atlas:readCgroupStats"},
+        root_{std::move(root)},
+        self_cgroup_{std::move(self_cgroup)} {}
+
+  void Execute() override {
+    stats_ = read_cgroup_stats(root_, self_cgroup_);
+  }
+
+ protected:
+  void HandleOKCallback() override {
+    Nan::HandleScope scope;
+    v8::Local<v8::Value> argv[] = {Nan::Null(), stats_to_object(stats_)};
+    callback->Call(2, argv, async_resource);
+  }
+
+ private:
+  std::string root_;
+  std::string self_cgroup_;
+  CgroupStats stats_;
+};
+
+NAN_METHOD(read_cgroup_stats) {
+  auto argc = info.Length();
+  if (argc == 0 || !info[argc - 1]->IsFunction()) {
+    Nan::ThrowError("readCgroupStats() expects a callback");
+    return;
+  }
+  std::string root = kDefaultCgroupRoot;
+  if (argc > 1 && info[0]->IsString()) {
+    root = *Nan::Utf8String(info[0]);
+  }
+  std::string self_cgroup = kSelfCgroup;
+  if (argc > 2 && info[1]->IsString()) {
+    self_cgroup = *Nan::Utf8String(info[1]);
+  }
+  auto callback = new Nan::Callback(info[argc - 1].As<v8::Function>());
+  Nan::AsyncQueueWorker(new CgroupWorker(callback, std::move(root),
+                                         std::move(self_cgroup)));
+}
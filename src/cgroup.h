@@ -0,0 +1,51 @@
+#pragma once
+
+#include <nan.h>
+#include <string>
+
+static constexpr const char* kDefaultCgroupRoot = "/sys/fs/cgroup";
+
+struct CgroupPressure {
+  // share of the last 10s some or all tasks were stalled, in percent
+  double avg10 = 0;
+  // total stall time in microseconds
+  uint64_t total_us = 0;
+};
+
+// what the cgroup of the process reports. Plain file parsing, safe to call
+// from any thread
+struct CgroupStats {
+  // 1 or 2, 0 if no cgroup files were found under the root
+  int version = 0;
+
+  bool has_cpu = false;
+  uint64_t nr_periods = 0;
+  uint64_t nr_throttled = 0;
+  uint64_t throttled_us = 0;
+
+  bool has_memory = false;
+  double memory_usage = 0;
+  // negative if there is no limit
+  double memory_limit = -1;
+
+  // PSI, cgroup v2 only
+  bool has_pressure = false;
+  CgroupPressure memory_some;
+  CgroupPressure memory_full;
+};
+
+// read the cgroup v2 files of the process, found under root from the path in
+// self_cgroup (normally /proc/self/cgroup), or cgroup v1 files under the cpu
+// and memory hierarchies of root
+CgroupStats read_cgroup_stats(const std::string& root,
+                              const std::string& self_cgroup);
+
+// sample the cgroup under root periodically from the thread pool, and
+// publish throttling and memory metrics from the event loop
+void start_cgroup_sampler(const std::string& root);
+
+void stop_cgroup_sampler();
+
+// readCgroupStats(root, [selfCgroup], callback) reads the cgroup files on the
+// thread pool and calls back with (err, stats)
+NAN_METHOD(read_cgroup_stats);
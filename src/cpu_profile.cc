@@ -0,0 +1,200 @@
+#include "cpu_profile.h"
+#include "atlas.h"
+#include "start_stop.h"
+#include <v8-profiler.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+using atlas::meter::Tag;
+
+static constexpr size_t kMaxScriptLength = 120;
+static constexpr const char* kProfileTitle = "atlas";
+// distinct function and script pairs ever reported. The top functions change
+// from window to window, so without a cap a long running process would keep
+// adding series
+static constexpr size_t kMaxReportedFunctions = 500;
+
+static v8::CpuProfiler* profiler = nullptr;
+static uv_timer_t window_timer;
+static bool window_timer_initialized = false;
+static CpuProfileOptions profile_options;
+
+// (function, script) -> samples
+using SelfSamples = std::map<std::pair<std::string, std::string>, int64_t>;
+
+// pairs that already have a series
+static std::set<std::pair<std::string, std::string>> reported_functions;
+
+// the last two components of the script path are enough to tell scripts
+// apart, and keep the tag value short
+static std::string short_script(const char* script) {
+  std::string s{script};
+  auto slash = s.rfind('/');
+  if (slash != std::string::npos && slash > 0) {
+    auto parent = s.rfind('/', slash - 1);
+    if (parent != std::string::npos) {
+      s = s.substr(parent + 1);
+    }
+  }
+  if (s.size() > kMaxScriptLength) {
+    s = s.substr(s.size() - kMaxScriptLength);
+  }
+  return s;
+}
+
+static void collect(const v8::CpuProfileNode* node, SelfSamples* samples,
+                    int64_t* total) {
+  auto hits = static_cast<int64_t>(node->GetHitCount());
+  *total += hits;
+  if (hits > 0) {
+    Nan::Utf8String fn{node->GetFunctionName()};
+    // (idle) is not CPU time
+    if (fn.length() == 0 || strcmp(*fn, "(idle)") != 0) {
+      Nan::Utf8String script{node->GetScriptResourceName()};
+      auto key = std::make_pair(
+          std::string{fn.length() > 0 ? *fn : "(anonymous)"},
+          short_script(script.length() > 0 ? *script : ""));
+      (*samples)[key] += hits;
+    }
+  }
+  for (int i = 0; i < node->GetChildrenCount(); ++i) {
+    collect(node->GetChild(i), samples, total);
+  }
+}
+
+static void record_self_time(const std::string& function,
+                             const std::string& script, double seconds) {
+  auto id = node_id("nodejs.cpuSelfTime")
+                ->WithTag(Tag::of("function", function))
+                ->WithTag(Tag::of("script", script));
+  atlas_registry()->dcounter(id)->Add(seconds);
+}
+
+static void report(const v8::CpuProfile* profile) {
+  SelfSamples samples;
+  int64_t total = 0;
+  collect(profile->GetTopDownRoot(), &samples, &total);
+  if (total == 0) {
+    return;
+  }
+
+  auto seconds_per_sample =
+      (profile->GetEndTime() - profile->GetStartTime()) / 1e6 / total;
+  std::vector<std::pair<int64_t, SelfSamples::const_iterator>> by_samples;
+  for (auto it = samples.cbegin(); it != samples.cend(); ++it) {
+    by_samples.emplace_back(it->second, it);
+  }
+  auto top_n = std::min(profile_options.top_n, by_samples.size());
+  std::partial_sort(
+      by_samples.begin(), by_samples.begin() + top_n, by_samples.end(),
+      [](const std::pair<int64_t, SelfSamples::const_iterator>& a,
+         const std::pair<int64_t, SelfSamples::const_iterator>& b) {
+        return a.first > b.first;
+      });
+
+  int64_t other = 0;
+  for (size_t i = 0; i < by_samples.size(); ++i) {
+    const auto& key = by_samples[i].second->first;
+    auto has_series = i < top_n && (reported_functions.count(key) > 0 ||
+                                    reported_functions.size() <
+                                        kMaxReportedFunctions);
+    if (has_series) {
+      reported_functions.insert(key);
+      record_self_time(key.first, key.second,
+                       by_samples[i].first * seconds_per_sample);
+    } else {
+      other += by_samples[i].first;
+    }
+  }
+  if (other > 0) {
+    record_self_time("(other)", "", other * seconds_per_sample);
+  }
+}
+
+static void start_window() {
+  Nan::HandleScope scope;
+  profiler->StartProfiling(Nan::New(kProfileTitle).ToLocalChecked(), false);
+}
+
+// stop the current window and free its profile, reporting it if requested
+static void end_window(bool report_profile) {
+  Nan::HandleScope scope;
+  auto profile =
+      profiler->StopProfiling(Nan::New(kProfileTitle).ToLocalChecked());
+  if (profile == nullptr) {
+    return;
+  }
+  if (report_profile) {
+    report(profile);
+  }
+  profile->Delete();
+}
+
+static void on_window(uv_timer_t*) {
+  end_window(true);
+  start_window();
+}
+
+void start_cpu_profile(const CpuProfileOptions& options) {
+  stop_cpu_profile();
+
+  profile_options = options;
+  profiler = v8::CpuProfiler::New(v8::Isolate::GetCurrent());
+  profiler->SetSamplingInterval(options.interval_us);
+  start_window();
+
+  if (!window_timer_initialized) {
+    uv_timer_init(uv_default_loop(), &window_timer);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&window_timer));
+    window_timer_initialized = true;
+  }
+  uv_timer_start(&window_timer, on_window, options.window_ms,
+                 options.window_ms);
+}
+
+void stop_cpu_profile() {
+  if (profiler == nullptr) {
+    return;
+  }
+  uv_timer_stop(&window_timer);
+  end_window(false);
+  profiler->Dispose();
+  profiler = nullptr;
+}
+
+NAN_METHOD(start_cpu_profile) {
+  CpuProfileOptions options;
+  if (info.Length() > 0 && info[0]->IsObject()) {
+    cpu_profile_options_from_object(info[0].As<v8::Object>(), &options);
+  }
+  start_cpu_profile(options);
+}
+
+NAN_METHOD(stop_cpu_profile) { stop_cpu_profile(); }
+
+void cpu_profile_options_from_object(const v8::Local<v8::Object>& object,
+                                     CpuProfileOptions* options) {
+  auto number = [&object](const char* key, double* value) {
+    auto maybe = Nan::Get(object, Nan::New(key).ToLocalChecked());
+    if (maybe.IsEmpty() || !maybe.ToLocalChecked()->IsNumber()) {
+      return false;
+    }
+    *value = Nan::To<double>(maybe.ToLocalChecked()).FromJust();
+    return *value >= 1;
+  };
+
+  double value;
+  if (number("intervalUs", &value)) {
+    options->interval_us = static_cast<int>(value);
+  }
+  if (number("windowMs", &value)) {
+    options->window_ms = static_cast<uint64_t>(value);
+  }
+  if (number("topN", &value)) {
+    options->top_n = static_cast<size_t>(value);
+  }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <nan.h>
+
+// low rate CPU profiling in rolling windows. At the end of each window the
+// self time of the top functions is added to the nodejs.cpuSelfTime
+// counter, tagged by function and script, and the profile is deleted
+struct CpuProfileOptions {
+  // sampling interval of the profiler
+  int interval_us = 10000;
+  // length of a window
+  uint64_t window_ms = 60 * 1000;
+  // functions reported per window, the rest is reported as (other). At most
+  // 500 distinct functions get a series over the life of the process
+  size_t top_n = 20;
+};
+
+// start profiling. Must be called from the JS thread
+void start_cpu_profile(const CpuProfileOptions& options);
+
+// stop profiling, discarding the current window
+void stop_cpu_profile();
+
+// parse an {intervalUs, windowMs, topN} object into options
+void cpu_profile_options_from_object(const v8::Local<v8::Object>& object,
+                                     CpuProfileOptions* options);
+
+// startCpuProfile({intervalUs: 10000, windowMs: 60000, topN: 20})
+NAN_METHOD(start_cpu_profile);
+
+// stopCpuProfile()
+NAN_METHOD(stop_cpu_profile);
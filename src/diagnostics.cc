@@ -0,0 +1,91 @@
+#include "diagnostics.h"
+#include "atlas.h"
+#include "lazy_gauges.h"
+#include "start_stop.h"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+using atlas::meter::Counter;
+
+static constexpr size_t kMaxErrors = 100;
+static constexpr int64_t kLogIntervalMs = 10 * 1000;
+static constexpr const char* kOtherErrors = "(other errors)";
+
+struct ErrorEntry {
+  std::string error;
+  int64_t count;
+  int64_t first_seen;
+  int64_t last_seen;
+};
+
+// errors seen after kMaxErrors distinct ones are tallied as kOtherErrors
+static std::unordered_map<std::string, ErrorEntry> invalid_ids;
+static std::shared_ptr<Counter> invalid_ids_counter;
+static int64_t last_log_ms = 0;
+static int64_t not_logged = 0;
+
+void record_invalid_id(const std::string& err_msg) {
+  if (!invalid_ids_counter) {
+    invalid_ids_counter =
+        atlas_registry()->counter(node_id("atlas.client.invalidIds"));
+  }
+  invalid_ids_counter->Increment();
+
+  auto now = wall_millis();
+  auto it = invalid_ids.find(err_msg);
+  if (it == invalid_ids.end()) {
+    auto key = invalid_ids.size() < kMaxErrors ? err_msg : kOtherErrors;
+    it = invalid_ids.emplace(key, ErrorEntry{key, 0, now, now}).first;
+  }
+  it->second.count++;
+  it->second.last_seen = now;
+
+  // writes to stderr block, so a hot call site gets one line per interval
+  if (now - last_log_ms < kLogIntervalMs) {
+    ++not_logged;
+    return;
+  }
+  if (not_logged > 0) {
+    fprintf(stderr,
+            "Error creating atlas metric ID: %s (%lld more invalid ids since "
+            "the last message, see atlas.diagnostics())\n",
+            err_msg.c_str(), static_cast<long long>(not_logged));
+  } else {
+    fprintf(stderr, "Error creating atlas metric ID: %s\n", err_msg.c_str());
+  }
+  last_log_ms = now;
+  not_logged = 0;
+}
+
+NAN_METHOD(diagnostics) {
+  std::vector<const ErrorEntry*> entries;
+  entries.reserve(invalid_ids.size());
+  for (const auto& kv : invalid_ids) {
+    entries.push_back(&kv.second);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const ErrorEntry* a, const ErrorEntry* b) {
+              return a->count > b->count;
+            });
+
+  auto errors = Nan::New<v8::Array>(static_cast<int>(entries.size()));
+  uint32_t i = 0;
+  for (auto e : entries) {
+    auto entry = Nan::New<v8::Object>();
+    Nan::Set(entry, Nan::New("error").ToLocalChecked(),
+             Nan::New(e->error).ToLocalChecked());
+    Nan::Set(entry, Nan::New("count").ToLocalChecked(),
+             Nan::New(static_cast<double>(e->count)));
+    Nan::Set(entry, Nan::New("firstSeen").ToLocalChecked(),
+             Nan::New(static_cast<double>(e->first_seen)));
+    Nan::Set(entry, Nan::New("lastSeen").ToLocalChecked(),
+             Nan::New(static_cast<double>(e->last_seen)));
+    Nan::Set(errors, i++, entry);
+  }
+
+  auto result = Nan::New<v8::Object>();
+  Nan::Set(result, Nan::New("invalidIds").ToLocalChecked(), errors);
+  info.GetReturnValue().Set(result);
+}
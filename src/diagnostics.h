@@ -0,0 +1,17 @@
+#pragma once
+
+#include <nan.h>
+#include <string>
+
+// problems the binding absorbs instead of throwing, kept in bounded tables
+// so they can be inspected without flooding stderr. Only call these from
+// the JS thread
+
+// an id could not be created, and the meter was given the invalid id.
+// Counts the error in a table keyed by its message and in
+// atlas.client.invalidIds, and logs at most one line per 10s
+void record_invalid_id(const std::string& err_msg);
+
+// diagnostics() returns
+// {invalidIds: [{error, count, firstSeen, lastSeen}]}, most frequent first
+NAN_METHOD(diagnostics);
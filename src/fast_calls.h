@@ -0,0 +1,64 @@
+#pragma once
+
+#include <nan.h>
+#include <initializer_list>
+#include <vector>
+
+// V8 fast API calls let optimized code call a C++ function directly, without
+// building a FunctionCallbackInfo or converting the arguments. They need a
+// V8 with a stable fast API and node headers that ship it
+#if defined(__has_include) && !defined(ATLAS_NO_FAST_CALLS)
+#if __has_include(<v8-fast-api-calls.h>) && V8_MAJOR_VERSION >= 10
+#include <v8-fast-api-calls.h>
+#define ATLAS_FAST_CALLS 1
+#endif
+#endif
+
+#ifdef ATLAS_FAST_CALLS
+using FastCall = v8::CFunction;
+#else
+struct FastCall {
+  template <typename F>
+  static FastCall Make(F) {
+    return FastCall{};
+  }
+};
+#endif
+
+constexpr bool kFastCalls =
+#ifdef ATLAS_FAST_CALLS
+    true;
+#else
+    false;
+#endif
+
+#ifdef ATLAS_FAST_CALLS
+template <Nan::FunctionCallback F>
+void SlowCall(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  Nan::FunctionCallbackInfo<v8::Value> nan_info{info, v8::Local<v8::Value>()};
+  F(nan_info);
+}
+#endif
+
+// like Nan::SetPrototypeMethod, also registering the fast overloads when
+// available. The overloads must differ in the number of arguments. F stays
+// in use for the interpreter and any call the overloads do not cover
+template <Nan::FunctionCallback F>
+void SetFastPrototypeMethod(v8::Local<v8::FunctionTemplate> tpl,
+                            const char* name,
+                            std::initializer_list<FastCall> overloads) {
+#ifdef ATLAS_FAST_CALLS
+  auto isolate = v8::Isolate::GetCurrent();
+  std::vector<v8::CFunction> functions{overloads};
+  auto method = v8::FunctionTemplate::NewWithCFunctionOverloads(
+      isolate, SlowCall<F>, v8::Local<v8::Value>(),
+      v8::Signature::New(isolate, tpl), 0, v8::ConstructorBehavior::kThrow,
+      v8::SideEffectType::kHasSideEffect, {functions.data(), functions.size()});
+  auto fn_name = Nan::New(name).ToLocalChecked();
+  method->SetClassName(fn_name);
+  tpl->PrototypeTemplate()->Set(fn_name, method);
+#else
+  static_cast<void>(overloads);
+  Nan::SetPrototypeMethod(tpl, name, F);
+#endif
+}
@@ -1,8 +1,12 @@
 #include "functions.h"
 #include "atlas.h"
+#include "memory_stats.h"
+#include "meter_args.h"
+#include "self_metrics.h"
 #include "utils.h"
 #include <atlas/meter/validation.h>
 #include <chrono>
+#include <cmath>
 #include <sstream>
 
 using atlas::meter::AnalyzeTags;
@@ -20,6 +24,17 @@ using v8::Local;
 using v8::Maybe;
 using v8::Object;
 
+// the slow path of a meter method taking the arguments described by Args,
+// one of the signatures in meter_args.h. Apply gets the decoded value
+template <typename T, typename Args,
+          void (T::*Apply)(typename Args::value_type)>
+static void MeterMethod(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  auto meter = JsMeter::Active<T>(info);
+  if (meter != nullptr) {
+    (meter->*Apply)(Args::Decode(info));
+  }
+}
+
 NAN_METHOD(set_dev_mode) {
   if (info.Length() == 1 && info[0]->IsBoolean()) {
     auto b = Nan::To<bool>(info[0]).FromJust();
@@ -27,6 +42,15 @@ NAN_METHOD(set_dev_mode) {
   }
 }
 
+NAN_METHOD(set_cardinality_limit) {
+  if (info.Length() == 1 && info[0]->IsNumber()) {
+    auto limit = Nan::To<double>(info[0]).FromJust();
+    set_cardinality_limit(limit > 0 ? static_cast<size_t>(limit) : 0);
+  } else {
+    Nan::ThrowError("setCardinalityLimit() expects a number");
+  }
+}
+
 static void addTags(v8::Isolate* isolate, const v8::Local<v8::Object>& object,
                     Tags* tags) {
   auto context = isolate->GetCurrentContext();
@@ -105,7 +129,35 @@ error:
   info.GetReturnValue().Set(ret);
 }
 
+static Local<Object> measurementToObject(Local<Context> context,
+                                         const Tags& common_tags,
+                                         Local<v8::String> name,
+                                         const Measurement& m) {
+  auto measurement = Nan::New<Object>();
+  auto tags = Nan::New<Object>();
+  tags->Set(context, name, Nan::New(m.id->Name()).ToLocalChecked()).FromJust();
+
+  const auto& t = m.id->GetTags();
+  for (const auto& kv : common_tags) {
+    tags->Set(context, Nan::New(kv.first.get()).ToLocalChecked(),
+              Nan::New(kv.second.get()).ToLocalChecked())
+        .FromJust();
+  }
+  for (const auto& kv : t) {
+    tags->Set(context, Nan::New(kv.first.get()).ToLocalChecked(),
+              Nan::New(kv.second.get()).ToLocalChecked())
+        .FromJust();
+  }
+  measurement->Set(context, Nan::New("tags").ToLocalChecked(), tags).FromJust();
+  measurement
+      ->Set(context, Nan::New("value").ToLocalChecked(), Nan::New(m.value))
+      .FromJust();
+  return measurement;
+}
+
 NAN_METHOD(measurements) {
+  SelfTimer self_timer{SelfOp::kMeasurements};
+  refresh_lazy_gauges(true);
   auto context = Nan::GetCurrentContext();
   auto config = atlas_client().GetConfig();
   auto common_tags = config->CommonTags();
@@ -115,32 +167,27 @@ NAN_METHOD(measurements) {
   auto name = Nan::New("name").ToLocalChecked();
 
   for (const auto& m : measurements) {
-    auto measurement = Nan::New<Object>();
-    auto tags = Nan::New<Object>();
-    tags->Set(context, name, Nan::New(m.id->Name()).ToLocalChecked()).FromJust();
-
-    const auto& t = m.id->GetTags();
-    for (const auto& kv : common_tags) {
-      tags->Set(context, Nan::New(kv.first.get()).ToLocalChecked(),
-                Nan::New(kv.second.get()).ToLocalChecked())
-          .FromJust();
-    }
-    for (const auto& kv : t) {
-      tags->Set(context, Nan::New(kv.first.get()).ToLocalChecked(),
-                Nan::New(kv.second.get()).ToLocalChecked())
-          .FromJust();
-    }
-    measurement->Set(context, Nan::New("tags").ToLocalChecked(), tags).FromJust();
-    measurement
-        ->Set(context, Nan::New("value").ToLocalChecked(), Nan::New(m.value))
+    ret->Set(context, ret->Length(),
+             measurementToObject(context, common_tags, name, m))
         .FromJust();
-    ret->Set(context, ret->Length(), measurement).FromJust();
   }
 
   info.GetReturnValue().Set(ret);
 }
 
+NAN_METHOD(measurements_cursor) {
+  refresh_lazy_gauges(true);
+  Local<v8::Value> argv[1] = {info[0]};
+  auto argc = info.Length() > 0 ? 1 : 0;
+  auto cons = Nan::New<Function>(JsMeasurementsCursor::constructor);
+  auto cursor = Nan::NewInstance(cons, argc, argv);
+  if (!cursor.IsEmpty()) {
+    info.GetReturnValue().Set(cursor.ToLocalChecked());
+  }
+}
+
 NAN_METHOD(config) {
+  SelfTimer self_timer{SelfOp::kConfig};
   auto currentCfg = atlas_client().GetConfig();
   const auto& endpoints = currentCfg->EndpointConfiguration();
   const auto& log = currentCfg->LogConfiguration();
@@ -231,6 +278,7 @@ static Measurement getMeasurement(v8::Isolate* isolate, Local<v8::Value> v) {
 }
 
 NAN_METHOD(push) {
+  SelfTimer self_timer{SelfOp::kPush};
   if (info.Length() == 1 && info[0]->IsArray()) {
     auto measurements = info[0].As<v8::Array>();
     auto context = Nan::GetCurrentContext();
@@ -262,6 +310,7 @@ static void CreateConstructor(const Nan::FunctionCallbackInfo<v8::Value>& info,
     Nan::ThrowError("Need at least a name argument");
     return;
   }
+  self_count_wrapper(name);
   Local<v8::Value> argv[kMaxArgs];
   for (auto i = 0; i < argc; ++i) {
     argv[i] = info[i];
@@ -326,25 +375,48 @@ NAN_METHOD(percentile_dist_summary) {
 
 NAN_METHOD(timer) { CreateConstructor(info, JsTimer::constructor, "timer"); }
 
+NAN_METHOD(sampled_timer) {
+  CreateConstructor(info, JsSampledTimer::constructor, "sampledTimer");
+}
+
 NAN_METHOD(long_task_timer) {
   CreateConstructor(info, JsLongTaskTimer::constructor, "longTaskTimer");
 }
 
 NAN_METHOD(gauge) { CreateConstructor(info, JsGauge::constructor, "gauge"); }
 
+NAN_METHOD(age_gauge) {
+  CreateConstructor(info, JsAgeGauge::constructor, "age");
+}
+
+NAN_METHOD(function_gauge) {
+  CreateConstructor(info, JsFunctionGauge::constructor, "functionGauge");
+}
+
+NAN_METHOD(set_lazy_gauge_interval) {
+  if (info.Length() == 1 && info[0]->IsNumber()) {
+    auto millis = Nan::To<double>(info[0]).FromJust();
+    set_lazy_gauge_interval(millis > 0 ? static_cast<uint64_t>(millis) : 1);
+  }
+}
+
 Nan::Persistent<Function> JsCounter::constructor;
 Nan::Persistent<Function> JsDCounter::constructor;
 Nan::Persistent<Function> JsIntervalCounter::constructor;
 Nan::Persistent<Function> JsTimer::constructor;
+Nan::Persistent<Function> JsSampledTimer::constructor;
 Nan::Persistent<Function> JsLongTaskTimer::constructor;
 Nan::Persistent<Function> JsGauge::constructor;
 Nan::Persistent<Function> JsMaxGauge::constructor;
+Nan::Persistent<Function> JsAgeGauge::constructor;
+Nan::Persistent<Function> JsFunctionGauge::constructor;
 Nan::Persistent<Function> JsDistSummary::constructor;
 Nan::Persistent<Function> JsBucketCounter::constructor;
 Nan::Persistent<Function> JsBucketDistSummary::constructor;
 Nan::Persistent<Function> JsBucketTimer::constructor;
 Nan::Persistent<Function> JsPercentileTimer::constructor;
 Nan::Persistent<Function> JsPercentileDistSummary::constructor;
+Nan::Persistent<Function> JsMeasurementsCursor::constructor;
 
 NAN_MODULE_INIT(JsCounter::Init) {
   // Prepare constructor template
@@ -354,8 +426,15 @@ NAN_MODULE_INIT(JsCounter::Init) {
 
   // Prototype
   Nan::SetPrototypeMethod(tpl, "count", Count);
-  Nan::SetPrototypeMethod(tpl, "add", Add);
-  Nan::SetPrototypeMethod(tpl, "increment", Increment);
+  SetFastPrototypeMethod<
+      MeterMethod<JsCounter, args::Number<long>, &JsCounter::AddAmount>>(
+      tpl, "add", {FastCall::Make(FastAdd)});
+  SetFastPrototypeMethod<
+      MeterMethod<JsCounter, args::Number<long, 1>, &JsCounter::AddAmount>>(
+      tpl, "increment",
+      {FastCall::Make(FastIncrement), FastCall::Make(FastAdd)});
+  JsMeter::SetPrototypeMethods(tpl);
+  JsMeter::SetRollingWindowMethod(tpl, RollingWindow::Kind::kCounter);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -374,32 +453,41 @@ NAN_METHOD(JsCounter::New) {
   }
 }
 
-NAN_METHOD(JsCounter::Increment) {
-  long value =
-      (long)(info[0]->IsUndefined()
-                 ? 1
-                 : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
-  JsCounter* ctr = Nan::ObjectWrap::Unwrap<JsCounter>(info.This());
-  ctr->counter_->Add(value);
+void JsCounter::AddAmount(long amount) {
+  counter_->Add(amount);
+  RecordWindow(amount);
 }
 
-NAN_METHOD(JsCounter::Add) {
-  long value =
-      (long)(info[0]->IsUndefined()
-                 ? 0
-                 : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
+void JsCounter::FastIncrement(v8::Local<v8::Object> receiver) {
+  auto ctr = JsMeter::Active<JsCounter>(receiver);
+  if (ctr != nullptr) {
+    ctr->AddAmount(1);
+  }
+}
 
-  JsCounter* ctr = Nan::ObjectWrap::Unwrap<JsCounter>(info.This());
-  ctr->counter_->Add(value);
+void JsCounter::FastAdd(v8::Local<v8::Object> receiver, double value) {
+  auto ctr = JsMeter::Active<JsCounter>(receiver);
+  if (ctr != nullptr) {
+    ctr->AddAmount(static_cast<long>(value));
+  }
 }
 
 NAN_METHOD(JsCounter::Count) {
-  JsCounter* ctr = Nan::ObjectWrap::Unwrap<JsCounter>(info.This());
+  auto ctr = JsMeter::Active<JsCounter>(info);
+  if (ctr == nullptr) {
+    return;
+  }
   double count = ctr->counter_->Count();
   info.GetReturnValue().Set(count);
 }
 
-JsCounter::JsCounter(IdPtr id) : counter_{atlas_registry()->counter(id)} {}
+JsCounter::JsCounter(IdPtr id) : JsMeter{MeterKind::kCounter, id} {
+  AcquireMeters();
+}
+
+void JsCounter::AcquireMeters() { counter_ = atlas_registry()->counter(id_); }
+
+void JsCounter::ReleaseMeters() { counter_.reset(); }
 
 NAN_MODULE_INIT(JsDCounter::Init) {
   // Prepare constructor template
@@ -409,8 +497,15 @@ NAN_MODULE_INIT(JsDCounter::Init) {
 
   // Prototype
   Nan::SetPrototypeMethod(tpl, "count", Count);
-  Nan::SetPrototypeMethod(tpl, "add", Add);
-  Nan::SetPrototypeMethod(tpl, "increment", Increment);
+  SetFastPrototypeMethod<
+      MeterMethod<JsDCounter, args::Number<double>, &JsDCounter::AddAmount>>(
+      tpl, "add", {FastCall::Make(FastAdd)});
+  SetFastPrototypeMethod<
+      MeterMethod<JsDCounter, args::Number<double, 1>, &JsDCounter::AddAmount>>(
+      tpl, "increment",
+      {FastCall::Make(FastIncrement), FastCall::Make(FastAdd)});
+  JsMeter::SetPrototypeMethods(tpl);
+  JsMeter::SetRollingWindowMethod(tpl, RollingWindow::Kind::kCounter);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -429,32 +524,41 @@ NAN_METHOD(JsDCounter::New) {
   }
 }
 
-NAN_METHOD(JsDCounter::Increment) {
-  double value =
-      info[0]->IsUndefined()
-          ? 1.0
-          : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust();
-  JsDCounter* ctr = Nan::ObjectWrap::Unwrap<JsDCounter>(info.This());
-  ctr->counter_->Add(value);
+void JsDCounter::AddAmount(double amount) {
+  counter_->Add(amount);
+  RecordWindow(amount);
 }
 
-NAN_METHOD(JsDCounter::Add) {
-  double value =
-      info[0]->IsUndefined()
-          ? 0.0
-          : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust();
+void JsDCounter::FastIncrement(v8::Local<v8::Object> receiver) {
+  auto ctr = JsMeter::Active<JsDCounter>(receiver);
+  if (ctr != nullptr) {
+    ctr->AddAmount(1.0);
+  }
+}
 
-  JsDCounter* ctr = Nan::ObjectWrap::Unwrap<JsDCounter>(info.This());
-  ctr->counter_->Add(value);
+void JsDCounter::FastAdd(v8::Local<v8::Object> receiver, double value) {
+  auto ctr = JsMeter::Active<JsDCounter>(receiver);
+  if (ctr != nullptr) {
+    ctr->AddAmount(value);
+  }
 }
 
 NAN_METHOD(JsDCounter::Count) {
-  JsDCounter* ctr = Nan::ObjectWrap::Unwrap<JsDCounter>(info.This());
+  auto ctr = JsMeter::Active<JsDCounter>(info);
+  if (ctr == nullptr) {
+    return;
+  }
   double count = ctr->counter_->Count();
   info.GetReturnValue().Set(count);
 }
 
-JsDCounter::JsDCounter(IdPtr id) : counter_{atlas_registry()->dcounter(id)} {}
+JsDCounter::JsDCounter(IdPtr id) : JsMeter{MeterKind::kDCounter, id} {
+  AcquireMeters();
+}
+
+void JsDCounter::AcquireMeters() { counter_ = atlas_registry()->dcounter(id_); }
+
+void JsDCounter::ReleaseMeters() { counter_.reset(); }
 
 NAN_MODULE_INIT(JsIntervalCounter::Init) {
   // Prepare constructor template
@@ -466,8 +570,15 @@ NAN_MODULE_INIT(JsIntervalCounter::Init) {
   Nan::SetPrototypeMethod(tpl, "count", Count);
   Nan::SetPrototypeMethod(tpl, "secondsSinceLastUpdate",
                           SecondsSinceLastUpdate);
-  Nan::SetPrototypeMethod(tpl, "add", Add);
-  Nan::SetPrototypeMethod(tpl, "increment", Increment);
+  Nan::SetPrototypeMethod(
+      tpl, "add",
+      MeterMethod<JsIntervalCounter, args::Number<long>,
+                  &JsIntervalCounter::AddAmount>);
+  Nan::SetPrototypeMethod(
+      tpl, "increment",
+      MeterMethod<JsIntervalCounter, args::Number<long, 1>,
+                  &JsIntervalCounter::AddAmount>);
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -487,44 +598,117 @@ NAN_METHOD(JsIntervalCounter::New) {
   }
 }
 
-NAN_METHOD(JsIntervalCounter::Increment) {
-  long value =
-      (long)(info[0]->IsUndefined()
-                 ? 1
-                 : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
-  JsIntervalCounter* ctr =
-      Nan::ObjectWrap::Unwrap<JsIntervalCounter>(info.This());
-  ctr->counter_->Add(value);
-}
-
-NAN_METHOD(JsIntervalCounter::Add) {
-  long value =
-      (long)(info[0]->IsUndefined()
-                 ? 0
-                 : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
-
-  JsIntervalCounter* ctr =
-      Nan::ObjectWrap::Unwrap<JsIntervalCounter>(info.This());
-  ctr->counter_->Add(value);
-}
+void JsIntervalCounter::AddAmount(long amount) { counter_->Add(amount); }
 
 NAN_METHOD(JsIntervalCounter::Count) {
-  JsIntervalCounter* ctr =
-      Nan::ObjectWrap::Unwrap<JsIntervalCounter>(info.This());
+  auto ctr = JsMeter::Active<JsIntervalCounter>(info);
+  if (ctr == nullptr) {
+    return;
+  }
   double count = ctr->counter_->Count();
   info.GetReturnValue().Set(count);
 }
 
 NAN_METHOD(JsIntervalCounter::SecondsSinceLastUpdate) {
-  JsIntervalCounter* ctr =
-      Nan::ObjectWrap::Unwrap<JsIntervalCounter>(info.This());
+  auto ctr = JsMeter::Active<JsIntervalCounter>(info);
+  if (ctr == nullptr) {
+    return;
+  }
   double seconds = ctr->counter_->SecondsSinceLastUpdate();
   info.GetReturnValue().Set(seconds);
 }
 
 JsIntervalCounter::JsIntervalCounter(IdPtr id)
-    : counter_{std::make_shared<atlas::meter::IntervalCounter>(atlas_registry(),
-                                                               id)} {}
+    : JsMeter{MeterKind::kIntervalCounter, id} {
+  AcquireMeters();
+}
+
+void JsIntervalCounter::AcquireMeters() {
+  counter_ = std::make_shared<atlas::meter::IntervalCounter>(atlas_registry(),
+                                                             id_);
+}
+
+void JsIntervalCounter::ReleaseMeters() { counter_.reset(); }
+
+// the data of a timePromise settle handler, in internal fields: the wrapper,
+// the original promise and the start time
+static Nan::Persistent<v8::ObjectTemplate> settle_data_template;
+
+// one handler for both outcomes: the original promise is settled by the time
+// it runs, so its state tells which
+template <typename T, bool kTagOutcome>
+static void OnPromiseSettled(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  auto now = atlas_registry()->clock().MonotonicTime();
+  auto data = info.Data().As<Object>();
+  auto holder = data->GetInternalField(0).As<Object>();
+  auto promise = data->GetInternalField(1).As<v8::Promise>();
+  auto start = data->GetInternalField(2).As<v8::Number>()->Value();
+  auto fulfilled = promise->State() == v8::Promise::kFulfilled;
+
+  // the wrapper may have been disposed while the promise was pending
+  auto wrapper = JsMeter::Active<T>(holder, true);
+  if (wrapper != nullptr) {
+    const char* outcome = nullptr;
+    if (kTagOutcome) {
+      outcome = fulfilled ? "success" : "failure";
+    }
+    wrapper->RecordSettled(now - static_cast<int64_t>(start), outcome);
+  }
+
+  // settle the derived promise the same way as the original
+  if (fulfilled) {
+    info.GetReturnValue().Set(info[0]);
+  } else {
+    info.GetIsolate()->ThrowException(info[0]);
+  }
+}
+
+// timePromise(promise, [{outcome: true}]) returns a promise that settles
+// like the original once the duration has been recorded
+template <typename T>
+static void TimePromise(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  if (info.Length() < 1 || !info[0]->IsPromise()) {
+    Nan::ThrowError("Expecting a promise as the argument to timePromise.");
+    return;
+  }
+  auto start = atlas_registry()->clock().MonotonicTime();
+  auto context = Nan::GetCurrentContext();
+
+  auto tag_outcome = false;
+  if (info.Length() > 1 && info[1]->IsObject()) {
+    auto maybe_outcome = info[1].As<Object>()->Get(
+        context, Nan::New("outcome").ToLocalChecked());
+    tag_outcome = !maybe_outcome.IsEmpty() &&
+                  Nan::To<bool>(maybe_outcome.ToLocalChecked()).FromJust();
+  }
+
+  if (settle_data_template.IsEmpty()) {
+    auto tpl = v8::ObjectTemplate::New(info.GetIsolate());
+    tpl->SetInternalFieldCount(3);
+    settle_data_template.Reset(tpl);
+  }
+  Local<Object> data;
+  if (!Nan::New(settle_data_template)->NewInstance(context).ToLocal(&data)) {
+    return;
+  }
+  auto promise = info[0].As<v8::Promise>();
+  data->SetInternalField(0, info.This());
+  data->SetInternalField(1, promise);
+  data->SetInternalField(2, Nan::New(static_cast<double>(start)));
+
+  auto handler = v8::Function::New(
+      context,
+      tag_outcome ? OnPromiseSettled<T, true> : OnPromiseSettled<T, false>,
+      data);
+  if (handler.IsEmpty()) {
+    return;
+  }
+  auto on_settled = handler.ToLocalChecked();
+  auto derived = promise->Then(context, on_settled, on_settled);
+  if (!derived.IsEmpty()) {
+    info.GetReturnValue().Set(derived.ToLocalChecked());
+  }
+}
 
 NAN_MODULE_INIT(JsTimer::Init) {
   Nan::HandleScope scope;
@@ -536,9 +720,14 @@ NAN_MODULE_INIT(JsTimer::Init) {
 
   // Prototype
   Nan::SetPrototypeMethod(tpl, "count", Count);
-  Nan::SetPrototypeMethod(tpl, "record", Record);
+  SetFastPrototypeMethod<
+      MeterMethod<JsTimer, args::Duration<>, &JsTimer::RecordNanos>>(
+      tpl, "record", {FastCall::Make(FastRecord)});
   Nan::SetPrototypeMethod(tpl, "timeThis", TimeThis);
+  Nan::SetPrototypeMethod(tpl, "timePromise", TimePromise);
   Nan::SetPrototypeMethod(tpl, "totalTime", TotalTime);
+  JsMeter::SetPrototypeMethods(tpl);
+  JsMeter::SetRollingWindowMethod(tpl, RollingWindow::Kind::kTimer);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -557,37 +746,22 @@ NAN_METHOD(JsTimer::New) {
   }
 }
 
-constexpr long NANOS = 1000L * 1000L * 1000L;
-NAN_METHOD(JsTimer::Record) {
-  JsTimer* timer = Nan::ObjectWrap::Unwrap<JsTimer>(info.This());
+void JsTimer::RecordNanos(int64_t nanos) {
+  timer_->Record(std::chrono::nanoseconds(nanos));
+  RecordWindow(nanos / 1e9);
+}
 
-  auto context = Nan::GetCurrentContext();
-  int64_t seconds = 0, nanos = 0;
-  if (info.Length() == 1 && info[0]->IsArray()) {
-    auto hrtime = info[0].As<v8::Array>();
-    if (hrtime->Length() == 2) {
-      seconds =
-          Nan::To<int64_t>(hrtime->Get(context, 0).ToLocalChecked()).FromJust();
-      nanos =
-          Nan::To<int64_t>(hrtime->Get(context, 1).ToLocalChecked()).FromJust();
-    } else {
-      Nan::ThrowError(
-          "Expecting an array of two elements: seconds, nanos. See "
-          "process.hrtime()");
-    }
-  } else {
-    seconds = (long)(info[0]->IsUndefined()
-                         ? 0
-                         : info[0]->NumberValue(context).FromJust());
-    nanos = (long)(info[1]->IsUndefined()
-                       ? 0
-                       : info[1]->NumberValue(context).FromJust());
+void JsTimer::FastRecord(v8::Local<v8::Object> receiver, double seconds,
+                         double nanos) {
+  auto timer = JsMeter::Active<JsTimer>(receiver);
+  if (timer != nullptr) {
+    timer->RecordNanos(args::Nanos(static_cast<int64_t>(seconds),
+                                   static_cast<int64_t>(nanos)));
   }
-  timer->timer_->Record(std::chrono::nanoseconds(seconds * NANOS + nanos));
 }
 
 NAN_METHOD(JsTimer::TimeThis) {
-  JsTimer* timer = Nan::ObjectWrap::Unwrap<JsTimer>(info.This());
+  auto timer = JsMeter::Active<JsTimer>(info);
 
   if (info.Length() != 1 || !info[0]->IsFunction()) {
     Nan::ThrowError("Expecting a function as the argument to timeThis.");
@@ -602,27 +776,265 @@ NAN_METHOD(JsTimer::TimeThis) {
         Nan::Call(function, context->Global(), 0, nullptr).ToLocalChecked();
 
     auto elapsed_nanos = clock.MonotonicTime() - start;
-    timer->timer_->Record(std::chrono::nanoseconds(elapsed_nanos));
+    if (timer != nullptr) {
+      timer->RecordNanos(elapsed_nanos);
+    }
     info.GetReturnValue().Set(result);
   }
 }
 
+NAN_METHOD(JsTimer::TimePromise) { ::TimePromise<JsTimer>(info); }
+
+void JsTimer::RecordSettled(int64_t nanos, const char* outcome) {
+  auto duration = std::chrono::nanoseconds(nanos);
+  RecordWindow(nanos / 1e9);
+  if (outcome == nullptr) {
+    timer_->Record(duration);
+    return;
+  }
+  auto success = outcome[0] == 's';
+  auto& sibling = success ? success_ : failure_;
+  if (!sibling) {
+    sibling = atlas_registry()->timer(
+        id_->WithTag(atlas::meter::Tag::of("result", outcome)));
+  }
+  sibling->Record(duration);
+}
+
 NAN_METHOD(JsTimer::TotalTime) {
-  JsTimer* tmr = Nan::ObjectWrap::Unwrap<JsTimer>(info.This());
+  auto tmr = JsMeter::Active<JsTimer>(info);
+  if (tmr == nullptr) {
+    return;
+  }
   double totalTime = tmr->timer_->TotalTime() / 1e9;
   info.GetReturnValue().Set(totalTime);
 }
 
 NAN_METHOD(JsTimer::Count) {
-  JsTimer* tmr = Nan::ObjectWrap::Unwrap<JsTimer>(info.This());
+  auto tmr = JsMeter::Active<JsTimer>(info);
+  if (tmr == nullptr) {
+    return;
+  }
   double count = tmr->timer_->Count();
   info.GetReturnValue().Set(count);
 }
 
-JsTimer::JsTimer(IdPtr id) : timer_{atlas_registry()->timer(id)} {}
+JsTimer::JsTimer(IdPtr id) : JsMeter{MeterKind::kTimer, id} {
+  AcquireMeters();
+}
+
+// the outcome siblings are created again when needed
+void JsTimer::AcquireMeters() { timer_ = atlas_registry()->timer(id_); }
+
+void JsTimer::ReleaseMeters() {
+  timer_.reset();
+  success_.reset();
+  failure_.reset();
+}
+
+NAN_MODULE_INIT(JsSampledTimer::Init) {
+  Nan::HandleScope scope;
+
+  // Prepare constructor template
+  Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
+  tpl->SetClassName(Nan::New("JsSampledTimer").ToLocalChecked());
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  // Prototype
+  Nan::SetPrototypeMethod(tpl, "count", Count);
+  Nan::SetPrototypeMethod(tpl, "record", Record);
+  Nan::SetPrototypeMethod(tpl, "timeThis", TimeThis);
+  Nan::SetPrototypeMethod(tpl, "start", Start);
+  Nan::SetPrototypeMethod(tpl, "stop", Stop);
+  Nan::SetPrototypeMethod(tpl, "totalTime", TotalTime);
+  JsMeter::SetPrototypeMethods(tpl);
+
+  auto context = Nan::GetCurrentContext();
+  constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
+  Nan::Set(target, Nan::New("JsSampledTimer").ToLocalChecked(),
+           tpl->GetFunction(context).ToLocalChecked());
+}
+
+// {rate: 100} records 1 in 100 events, {rate: 0.01} is equivalent. 0 when
+// the rate is missing or the factor is above kMaxSamplingFactor
+static uint32_t samplingFactor(Local<Object> options) {
+  auto context = Nan::GetCurrentContext();
+  auto maybe_rate = options->Get(context, Nan::New("rate").ToLocalChecked());
+  if (maybe_rate.IsEmpty() || !maybe_rate.ToLocalChecked()->IsNumber()) {
+    return 0;
+  }
+  auto rate = Nan::To<double>(maybe_rate.ToLocalChecked()).FromJust();
+  if (!(rate > 0)) {
+    return 0;
+  }
+  auto factor = std::round(rate < 1 ? 1 / rate : rate);
+  return factor > kMaxSamplingFactor ? 0 : static_cast<uint32_t>(factor);
+}
+
+NAN_METHOD(JsSampledTimer::New) {
+  const auto argc = info.Length();
+  uint32_t factor = 0;
+  if (argc == 3 && info[2]->IsObject()) {
+    factor = samplingFactor(info[2].As<Object>());
+  }
+  if (factor == 0) {
+    Nan::ThrowError(
+        "Expecting three arguments: a name, tags, and an object with a "
+        "positive sampling 'rate' of at most 10000");
+    return;
+  }
+
+  if (info.IsConstructCall()) {
+    // Invoked as constructor: `new JsSampledTimer(...)`
+    auto obj = new JsSampledTimer(idFromValue(info, argc - 1), factor);
+    obj->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  } else {
+    Nan::ThrowError("not implemented");
+  }
+}
+
+// one update per sample, standing for Factor() events of that duration
+void JsSampledTimer::RecordSample(int64_t nanos) noexcept {
+  if (nanos < 0) {
+    return;
+  }
+  auto factor = sampler_.Factor();
+  auto seconds = nanos / 1e9;
+  count_->Add(factor);
+  total_time_->Add(factor * seconds);
+  total_of_squares_->Add(factor * seconds * seconds);
+  max_->Update(seconds);
+}
+
+NAN_METHOD(JsSampledTimer::Record) {
+  auto timer = JsMeter::Active<JsSampledTimer>(info);
+  if (timer == nullptr) {
+    return;
+  }
+  // decide before decoding any arguments
+  if (!timer->sampler_.Sample()) {
+    return;
+  }
+  timer->RecordSample(args::Duration<>::Decode(info));
+}
+
+NAN_METHOD(JsSampledTimer::TimeThis) {
+  auto timer = JsMeter::Active<JsSampledTimer>(info);
+
+  if (info.Length() != 1 || !info[0]->IsFunction()) {
+    Nan::ThrowError("Expecting a function as the argument to timeThis.");
+    return;
+  }
+
+  auto context = Nan::GetCurrentContext();
+  auto function = info[0].As<v8::Function>();
+  if (timer == nullptr || !timer->sampler_.Sample()) {
+    // not sampled, or disposed: no clock reads
+    auto result = Nan::Call(function, context->Global(), 0, nullptr);
+    if (!result.IsEmpty()) {
+      info.GetReturnValue().Set(result.ToLocalChecked());
+    }
+    return;
+  }
+
+  const auto& clock = atlas_registry()->clock();
+  auto start = clock.MonotonicTime();
+  auto result = Nan::Call(function, context->Global(), 0, nullptr);
+  timer->RecordSample(clock.MonotonicTime() - start);
+  if (!result.IsEmpty()) {
+    info.GetReturnValue().Set(result.ToLocalChecked());
+  }
+}
+
+// returns a token to pass to stop(), 0 when this event is not sampled
+NAN_METHOD(JsSampledTimer::Start) {
+  auto timer = JsMeter::Active<JsSampledTimer>(info);
+  if (timer == nullptr) {
+    return;
+  }
+  double token = 0;
+  if (timer->sampler_.Sample()) {
+    token = static_cast<double>(atlas_registry()->clock().MonotonicTime());
+  }
+  info.GetReturnValue().Set(token);
+}
+
+NAN_METHOD(JsSampledTimer::Stop) {
+  if (info.Length() == 0 || !info[0]->IsNumber()) {
+    return;
+  }
+  auto start = static_cast<int64_t>(info[0].As<v8::Number>()->Value());
+  if (start == 0) {
+    return;
+  }
+  auto timer = JsMeter::Active<JsSampledTimer>(info);
+  if (timer == nullptr) {
+    return;
+  }
+  timer->RecordSample(atlas_registry()->clock().MonotonicTime() - start);
+}
+
+NAN_METHOD(JsSampledTimer::TotalTime) {
+  auto tmr = JsMeter::Active<JsSampledTimer>(info);
+  if (tmr == nullptr) {
+    return;
+  }
+  double totalTime = tmr->total_time_->Count();
+  info.GetReturnValue().Set(totalTime);
+}
+
+NAN_METHOD(JsSampledTimer::Count) {
+  auto tmr = JsMeter::Active<JsSampledTimer>(info);
+  if (tmr == nullptr) {
+    return;
+  }
+  double count = tmr->count_->Count();
+  info.GetReturnValue().Set(count);
+}
+
+static IdPtr withSampleRate(IdPtr id, uint32_t factor) {
+  std::ostringstream os;
+  os << 1.0 / factor;
+  return id->WithTag(atlas::meter::Tag::of("sampleRate", os.str()));
+}
+
+JsSampledTimer::JsSampledTimer(IdPtr id, uint32_t factor)
+    : JsMeter{MeterKind::kTimer, withSampleRate(id, factor)},
+      sampler_{factor,
+               static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this))} {
+  AcquireMeters();
+}
+
+// published like a timer: one series per statistic
+void JsSampledTimer::AcquireMeters() {
+  auto r = atlas_registry();
+  auto stat = [this](const char* statistic) {
+    return id_->WithTag(atlas::meter::Tag::of("statistic", statistic));
+  };
+  count_ = r->counter(stat("count"));
+  total_time_ = r->dcounter(stat("totalTime"));
+  total_of_squares_ = r->dcounter(stat("totalOfSquares"));
+  max_ = r->max_gauge(stat("max"));
+}
+
+void JsSampledTimer::ReleaseMeters() {
+  count_.reset();
+  total_time_.reset();
+  total_of_squares_.reset();
+  max_.reset();
+}
 
 JsLongTaskTimer::JsLongTaskTimer(IdPtr id)
-    : timer_{atlas_registry()->long_task_timer(id)} {}
+    : JsMeter{MeterKind::kLongTaskTimer, id} {
+  AcquireMeters();
+}
+
+void JsLongTaskTimer::AcquireMeters() {
+  timer_ = atlas_registry()->long_task_timer(id_);
+}
+
+void JsLongTaskTimer::ReleaseMeters() { timer_.reset(); }
 
 NAN_MODULE_INIT(JsLongTaskTimer::Init) {
   Nan::HandleScope scope;
@@ -637,6 +1049,7 @@ NAN_MODULE_INIT(JsLongTaskTimer::Init) {
   Nan::SetPrototypeMethod(tpl, "stop", Stop);
   Nan::SetPrototypeMethod(tpl, "duration", Duration);
   Nan::SetPrototypeMethod(tpl, "activeTasks", ActiveTasks);
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -657,30 +1070,33 @@ NAN_METHOD(JsLongTaskTimer::New) {
 }
 
 NAN_METHOD(JsLongTaskTimer::Start) {
-  auto wrapper = Nan::ObjectWrap::Unwrap<JsLongTaskTimer>(info.This());
+  auto wrapper = JsMeter::Active<JsLongTaskTimer>(info);
+  if (wrapper == nullptr) {
+    return;
+  }
   auto start = (double)wrapper->timer_->Start();
   info.GetReturnValue().Set(start);
 }
 
 NAN_METHOD(JsLongTaskTimer::Stop) {
-  auto wrapper = Nan::ObjectWrap::Unwrap<JsLongTaskTimer>(info.This());
-  auto id = (int64_t)(
-      info[0]->IsUndefined()
-          ? 0
-          : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
+  auto wrapper = JsMeter::Active<JsLongTaskTimer>(info);
+  if (wrapper == nullptr) {
+    return;
+  }
+  auto id = args::Number<int64_t>::Decode(info);
   auto duration = (double)wrapper->timer_->Stop(id);
   info.GetReturnValue().Set(duration);
 }
 
 NAN_METHOD(JsLongTaskTimer::Duration) {
-  auto wrapper = Nan::ObjectWrap::Unwrap<JsLongTaskTimer>(info.This());
+  auto wrapper = JsMeter::Active<JsLongTaskTimer>(info);
+  if (wrapper == nullptr) {
+    return;
+  }
   auto& tmr = wrapper->timer_;
   double duration;
   if (info.Length() > 0) {
-    auto id = (int64_t)(
-        info[0]->IsUndefined()
-            ? 0
-            : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
+    auto id = args::Number<int64_t>::Decode(info);
     duration = (double)tmr->Duration(id);
   } else {
     duration = (double)tmr->Duration();
@@ -689,7 +1105,10 @@ NAN_METHOD(JsLongTaskTimer::Duration) {
 }
 
 NAN_METHOD(JsLongTaskTimer::ActiveTasks) {
-  auto wrapper = Nan::ObjectWrap::Unwrap<JsLongTaskTimer>(info.This());
+  auto wrapper = JsMeter::Active<JsLongTaskTimer>(info);
+  if (wrapper == nullptr) {
+    return;
+  }
   auto tasks = wrapper->timer_->ActiveTasks();
   info.GetReturnValue().Set(tasks);
 }
@@ -704,7 +1123,10 @@ NAN_MODULE_INIT(JsGauge::Init) {
 
   // Prototype
   Nan::SetPrototypeMethod(tpl, "value", Value);
-  Nan::SetPrototypeMethod(tpl, "update", Update);
+  SetFastPrototypeMethod<
+      MeterMethod<JsGauge, args::Number<double>, &JsGauge::UpdateValue>>(
+      tpl, "update", {FastCall::Make(FastUpdate)});
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -725,21 +1147,31 @@ NAN_METHOD(JsGauge::New) {
   }
 }
 
-NAN_METHOD(JsGauge::Update) {
-  JsGauge* g = Nan::ObjectWrap::Unwrap<JsGauge>(info.This());
-  auto value = info[0]->IsUndefined()
-                   ? 0
-                   : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust();
-  g->gauge_->Update(value);
+void JsGauge::UpdateValue(double value) { gauge_->Update(value); }
+
+void JsGauge::FastUpdate(v8::Local<v8::Object> receiver, double value) {
+  auto g = JsMeter::Active<JsGauge>(receiver);
+  if (g != nullptr) {
+    g->UpdateValue(value);
+  }
 }
 
 NAN_METHOD(JsGauge::Value) {
-  JsGauge* g = Nan::ObjectWrap::Unwrap<JsGauge>(info.This());
+  auto g = JsMeter::Active<JsGauge>(info);
+  if (g == nullptr) {
+    return;
+  }
   auto value = g->gauge_->Value();
   info.GetReturnValue().Set(value);
 }
 
-JsGauge::JsGauge(IdPtr id) : gauge_{atlas_registry()->gauge(id)} {}
+JsGauge::JsGauge(IdPtr id) : JsMeter{MeterKind::kGauge, id} {
+  AcquireMeters();
+}
+
+void JsGauge::AcquireMeters() { gauge_ = atlas_registry()->gauge(id_); }
+
+void JsGauge::ReleaseMeters() { gauge_.reset(); }
 
 NAN_MODULE_INIT(JsMaxGauge::Init) {
   Nan::HandleScope scope;
@@ -751,7 +1183,10 @@ NAN_MODULE_INIT(JsMaxGauge::Init) {
 
   // Prototype
   Nan::SetPrototypeMethod(tpl, "value", Value);
-  Nan::SetPrototypeMethod(tpl, "update", Update);
+  SetFastPrototypeMethod<
+      MeterMethod<JsMaxGauge, args::Number<double>, &JsMaxGauge::UpdateValue>>(
+      tpl, "update", {FastCall::Make(FastUpdate)});
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -772,21 +1207,166 @@ NAN_METHOD(JsMaxGauge::New) {
 }
 
 NAN_METHOD(JsMaxGauge::Value) {
-  JsMaxGauge* g = Nan::ObjectWrap::Unwrap<JsMaxGauge>(info.This());
+  auto g = JsMeter::Active<JsMaxGauge>(info);
+  if (g == nullptr) {
+    return;
+  }
   auto value = g->max_gauge_->Value();
   info.GetReturnValue().Set(value);
 }
 
-NAN_METHOD(JsMaxGauge::Update) {
-  JsMaxGauge* g = Nan::ObjectWrap::Unwrap<JsMaxGauge>(info.This());
-  auto value = info[0]->IsUndefined()
-                   ? 0.0
-                   : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust();
-  g->max_gauge_->Update(value);
+void JsMaxGauge::UpdateValue(double value) { max_gauge_->Update(value); }
+
+void JsMaxGauge::FastUpdate(v8::Local<v8::Object> receiver, double value) {
+  auto g = JsMeter::Active<JsMaxGauge>(receiver);
+  if (g != nullptr) {
+    g->UpdateValue(value);
+  }
+}
+
+JsMaxGauge::JsMaxGauge(IdPtr id) : JsMeter{MeterKind::kMaxGauge, id} {
+  AcquireMeters();
+}
+
+void JsMaxGauge::AcquireMeters() {
+  max_gauge_ = atlas_registry()->max_gauge(id_);
+}
+
+void JsMaxGauge::ReleaseMeters() { max_gauge_.reset(); }
+
+NAN_MODULE_INIT(JsAgeGauge::Init) {
+  Nan::HandleScope scope;
+
+  // Prepare constructor template
+  Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
+  tpl->SetClassName(Nan::New("JsAgeGauge").ToLocalChecked());
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  // Prototype
+  Nan::SetPrototypeMethod(tpl, "value", Value);
+  Nan::SetPrototypeMethod(tpl, "update", Update);
+  JsMeter::SetPrototypeMethods(tpl);
+
+  auto context = Nan::GetCurrentContext();
+  constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
+  Nan::Set(target, Nan::New("JsAgeGauge").ToLocalChecked(),
+           tpl->GetFunction(context).ToLocalChecked());
+}
+
+NAN_METHOD(JsAgeGauge::New) {
+  if (info.IsConstructCall()) {
+    // Invoked as constructor: `new JsAgeGauge(...)`
+    auto obj = new JsAgeGauge(idFromValue(info, info.Length()));
+    obj->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  } else {
+    Nan::ThrowError("not implemented");
+  }
+}
+
+// update([timestamp]) - timestamp in milliseconds since the epoch, defaults
+// to now
+NAN_METHOD(JsAgeGauge::Update) {
+  auto g = JsMeter::Active<JsAgeGauge>(info);
+  if (g == nullptr) {
+    return;
+  }
+  auto updated =
+      info.Length() > 0 && info[0]->IsNumber()
+          ? static_cast<int64_t>(info[0].As<v8::Number>()->Value())
+          : wall_millis();
+  if (updated == 0) {
+    updated = wall_millis();
+  }
+  g->age_gauge_->Update(updated);
+}
+
+NAN_METHOD(JsAgeGauge::Value) {
+  auto g = JsMeter::Active<JsAgeGauge>(info);
+  if (g == nullptr) {
+    return;
+  }
+  info.GetReturnValue().Set(g->age_gauge_->Age());
+}
+
+JsAgeGauge::JsAgeGauge(IdPtr id) : JsMeter{MeterKind::kGauge, id} {
+  AcquireMeters();
+}
+
+void JsAgeGauge::AcquireMeters() {
+  age_gauge_ = std::make_shared<AgeGauge>(atlas_registry()->gauge(id_));
+  register_lazy_gauge(age_gauge_);
 }
 
-JsMaxGauge::JsMaxGauge(IdPtr id)
-    : max_gauge_{atlas_registry()->max_gauge(id)} {}
+void JsAgeGauge::ReleaseMeters() {
+  unregister_lazy_gauge(age_gauge_.get());
+  age_gauge_.reset();
+}
+
+NAN_MODULE_INIT(JsFunctionGauge::Init) {
+  Nan::HandleScope scope;
+
+  // Prepare constructor template
+  Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
+  tpl->SetClassName(Nan::New("JsFunctionGauge").ToLocalChecked());
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  // Prototype
+  Nan::SetPrototypeMethod(tpl, "value", Value);
+  JsMeter::SetPrototypeMethods(tpl);
+
+  auto context = Nan::GetCurrentContext();
+  constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
+  Nan::Set(target, Nan::New("JsFunctionGauge").ToLocalChecked(),
+           tpl->GetFunction(context).ToLocalChecked());
+}
+
+NAN_METHOD(JsFunctionGauge::New) {
+  const auto argc = info.Length();
+  if (argc < 2 || !info[argc - 1]->IsFunction()) {
+    Nan::ThrowError(
+        "Need at least two arguments: a name, and a function returning the "
+        "value of the gauge");
+    return;
+  }
+
+  if (info.IsConstructCall()) {
+    // Invoked as constructor: `new JsFunctionGauge(...)`
+    auto obj = new JsFunctionGauge(idFromValue(info, argc - 1),
+                                   info[argc - 1].As<Function>());
+    obj->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  } else {
+    Nan::ThrowError("not implemented");
+  }
+}
+
+NAN_METHOD(JsFunctionGauge::Value) {
+  auto g = JsMeter::Active<JsFunctionGauge>(info);
+  if (g == nullptr) {
+    return;
+  }
+  g->function_gauge_->Refresh();
+  info.GetReturnValue().Set(g->function_gauge_->Value());
+}
+
+JsFunctionGauge::JsFunctionGauge(IdPtr id, Local<Function> function)
+    : JsMeter{MeterKind::kGauge, id} {
+  function_.Reset(function);
+  AcquireMeters();
+}
+
+void JsFunctionGauge::AcquireMeters() {
+  Nan::HandleScope scope;
+  function_gauge_ = std::make_shared<FunctionGauge>(
+      atlas_registry()->gauge(id_), Nan::New(function_));
+  register_lazy_gauge(function_gauge_);
+}
+
+void JsFunctionGauge::ReleaseMeters() {
+  unregister_lazy_gauge(function_gauge_.get());
+  function_gauge_.reset();
+}
 
 NAN_MODULE_INIT(JsDistSummary::Init) {
   Nan::HandleScope scope;
@@ -799,7 +1379,10 @@ NAN_MODULE_INIT(JsDistSummary::Init) {
   // Prototype
   Nan::SetPrototypeMethod(tpl, "totalAmount", TotalAmount);
   Nan::SetPrototypeMethod(tpl, "count", Count);
-  Nan::SetPrototypeMethod(tpl, "record", Record);
+  SetFastPrototypeMethod<MeterMethod<JsDistSummary, args::Number<int64_t>,
+                                     &JsDistSummary::RecordValue>>(
+      tpl, "record", {FastCall::Make(FastRecord)});
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -820,28 +1403,44 @@ NAN_METHOD(JsDistSummary::New) {
 }
 
 NAN_METHOD(JsDistSummary::Count) {
-  JsDistSummary* g = Nan::ObjectWrap::Unwrap<JsDistSummary>(info.This());
+  auto g = JsMeter::Active<JsDistSummary>(info);
+  if (g == nullptr) {
+    return;
+  }
   auto value = (double)(g->dist_summary_->Count());
   info.GetReturnValue().Set(value);
 }
 
 NAN_METHOD(JsDistSummary::TotalAmount) {
-  JsDistSummary* g = Nan::ObjectWrap::Unwrap<JsDistSummary>(info.This());
+  auto g = JsMeter::Active<JsDistSummary>(info);
+  if (g == nullptr) {
+    return;
+  }
   auto value = (double)(g->dist_summary_->TotalAmount());
   info.GetReturnValue().Set(value);
 }
 
-NAN_METHOD(JsDistSummary::Record) {
-  JsDistSummary* g = Nan::ObjectWrap::Unwrap<JsDistSummary>(info.This());
-  auto value = static_cast<int64_t>(
-      info[0]->IsUndefined()
-          ? 0
-          : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
-  g->dist_summary_->Record(value);
+void JsDistSummary::RecordValue(int64_t value) {
+  dist_summary_->Record(value);
+}
+
+void JsDistSummary::FastRecord(v8::Local<v8::Object> receiver, double value) {
+  auto g = JsMeter::Active<JsDistSummary>(receiver);
+  if (g != nullptr) {
+    g->RecordValue(static_cast<int64_t>(value));
+  }
 }
 
 JsDistSummary::JsDistSummary(IdPtr id)
-    : dist_summary_{atlas_registry()->distribution_summary(id)} {}
+    : JsMeter{MeterKind::kDistSummary, id} {
+  AcquireMeters();
+}
+
+void JsDistSummary::AcquireMeters() {
+  dist_summary_ = atlas_registry()->distribution_summary(id_);
+}
+
+void JsDistSummary::ReleaseMeters() { dist_summary_.reset(); }
 
 static std::string kEmptyString;
 static int64_t GetNumKey(Local<v8::Context> context, Local<Object> object,
@@ -979,7 +1578,11 @@ NAN_MODULE_INIT(JsBucketCounter::Init) {
   tpl->InstanceTemplate()->SetInternalFieldCount(1);
 
   // Prototype
-  Nan::SetPrototypeMethod(tpl, "record", Record);
+  Nan::SetPrototypeMethod(
+      tpl, "record",
+      MeterMethod<JsBucketCounter, args::Number<uint64_t>,
+                  &JsBucketCounter::RecordValue>);
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -1010,18 +1613,22 @@ NAN_METHOD(JsBucketCounter::New) {
   }
 }
 
-NAN_METHOD(JsBucketCounter::Record) {
-  auto g = Nan::ObjectWrap::Unwrap<JsBucketCounter>(info.This());
-  auto value = (uint64_t)(
-      info[0]->IsUndefined()
-          ? 0
-          : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
-  g->bucket_counter_->Record(value);
+void JsBucketCounter::RecordValue(uint64_t value) {
+  bucket_counter_->Record(value);
 }
 
 JsBucketCounter::JsBucketCounter(IdPtr id, BucketFunction bucket_function)
-    : bucket_counter_{std::make_shared<atlas::meter::BucketCounter>(
-          atlas_registry(), id, bucket_function)} {}
+    : JsMeter{MeterKind::kBucketCounter, id},
+      bucket_function_{std::move(bucket_function)} {
+  AcquireMeters();
+}
+
+void JsBucketCounter::AcquireMeters() {
+  bucket_counter_ = std::make_shared<atlas::meter::BucketCounter>(
+      atlas_registry(), id_, bucket_function_);
+}
+
+void JsBucketCounter::ReleaseMeters() { bucket_counter_.reset(); }
 
 NAN_MODULE_INIT(JsBucketDistSummary::Init) {
   Nan::HandleScope scope;
@@ -1032,7 +1639,11 @@ NAN_MODULE_INIT(JsBucketDistSummary::Init) {
   tpl->InstanceTemplate()->SetInternalFieldCount(1);
 
   // Prototype
-  Nan::SetPrototypeMethod(tpl, "record", Record);
+  Nan::SetPrototypeMethod(
+      tpl, "record",
+      MeterMethod<JsBucketDistSummary, args::Number<uint64_t>,
+                  &JsBucketDistSummary::RecordValue>);
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -1063,20 +1674,24 @@ NAN_METHOD(JsBucketDistSummary::New) {
   }
 }
 
-NAN_METHOD(JsBucketDistSummary::Record) {
-  auto g = Nan::ObjectWrap::Unwrap<JsBucketDistSummary>(info.This());
-  auto value = (uint64_t)(
-      info[0]->IsUndefined()
-          ? 0
-          : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
-  g->bucket_dist_summary_->Record(value);
+void JsBucketDistSummary::RecordValue(uint64_t value) {
+  bucket_dist_summary_->Record(value);
 }
 
 JsBucketDistSummary::JsBucketDistSummary(IdPtr id,
                                          BucketFunction bucket_function)
-    : bucket_dist_summary_{
-          std::make_shared<atlas::meter::BucketDistributionSummary>(
-              atlas_registry(), id, bucket_function)} {}
+    : JsMeter{MeterKind::kBucketDistSummary, id},
+      bucket_function_{std::move(bucket_function)} {
+  AcquireMeters();
+}
+
+void JsBucketDistSummary::AcquireMeters() {
+  bucket_dist_summary_ =
+      std::make_shared<atlas::meter::BucketDistributionSummary>(
+          atlas_registry(), id_, bucket_function_);
+}
+
+void JsBucketDistSummary::ReleaseMeters() { bucket_dist_summary_.reset(); }
 
 NAN_MODULE_INIT(JsBucketTimer::Init) {
   Nan::HandleScope scope;
@@ -1087,7 +1702,12 @@ NAN_MODULE_INIT(JsBucketTimer::Init) {
   tpl->InstanceTemplate()->SetInternalFieldCount(1);
 
   // Prototype
-  Nan::SetPrototypeMethod(tpl, "record", Record);
+  Nan::SetPrototypeMethod(
+      tpl, "record",
+      MeterMethod<JsBucketTimer, args::Duration<>,
+                  &JsBucketTimer::RecordNanos>);
+  Nan::SetPrototypeMethod(tpl, "timePromise", TimePromise);
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -1118,37 +1738,45 @@ NAN_METHOD(JsBucketTimer::New) {
   }
 }
 
-NAN_METHOD(JsBucketTimer::Record) {
-  auto g = Nan::ObjectWrap::Unwrap<JsBucketTimer>(info.This());
-  auto context = Nan::GetCurrentContext();
+void JsBucketTimer::RecordNanos(int64_t nanos) {
+  bucket_timer_->Record(std::chrono::nanoseconds(nanos));
+}
 
-  int64_t seconds = 0, nanos = 0;
-  if (info.Length() == 1 && info[0]->IsArray()) {
-    auto hrtime = info[0].As<v8::Array>();
-    if (hrtime->Length() == 2) {
-      seconds =
-          Nan::To<int64_t>(hrtime->Get(context, 0).ToLocalChecked()).FromJust();
-      nanos =
-          Nan::To<int64_t>(hrtime->Get(context, 1).ToLocalChecked()).FromJust();
-    } else {
-      Nan::ThrowError(
-          "Expecting an array of two elements: seconds, nanos. See "
-          "process.hrtime()");
-    }
-  } else {
-    seconds = (long)(info[0]->IsUndefined()
-                         ? 0
-                         : info[0]->NumberValue(context).FromJust());
-    nanos = (long)(info[1]->IsUndefined()
-                       ? 0
-                       : info[1]->NumberValue(context).FromJust());
+NAN_METHOD(JsBucketTimer::TimePromise) { ::TimePromise<JsBucketTimer>(info); }
+
+void JsBucketTimer::RecordSettled(int64_t nanos, const char* outcome) {
+  auto duration = std::chrono::nanoseconds(nanos);
+  if (outcome == nullptr) {
+    bucket_timer_->Record(duration);
+    return;
+  }
+  auto success = outcome[0] == 's';
+  auto& sibling = success ? success_ : failure_;
+  if (!sibling) {
+    sibling = std::make_shared<atlas::meter::BucketTimer>(
+        atlas_registry(),
+        id_->WithTag(atlas::meter::Tag::of("result", outcome)),
+        bucket_function_);
   }
-  g->bucket_timer_->Record(std::chrono::nanoseconds(seconds * NANOS + nanos));
+  sibling->Record(duration);
 }
 
 JsBucketTimer::JsBucketTimer(IdPtr id, BucketFunction bucket_function)
-    : bucket_timer_{std::make_shared<atlas::meter::BucketTimer>(
-          atlas_registry(), id, bucket_function)} {}
+    : JsMeter{MeterKind::kBucketTimer, id},
+      bucket_function_{std::move(bucket_function)} {
+  AcquireMeters();
+}
+
+void JsBucketTimer::AcquireMeters() {
+  bucket_timer_ = std::make_shared<atlas::meter::BucketTimer>(
+      atlas_registry(), id_, bucket_function_);
+}
+
+void JsBucketTimer::ReleaseMeters() {
+  bucket_timer_.reset();
+  success_.reset();
+  failure_.reset();
+}
 
 NAN_MODULE_INIT(JsPercentileTimer::Init) {
   Nan::HandleScope scope;
@@ -1159,10 +1787,16 @@ NAN_MODULE_INIT(JsPercentileTimer::Init) {
   tpl->InstanceTemplate()->SetInternalFieldCount(1);
 
   // Prototype
-  Nan::SetPrototypeMethod(tpl, "record", Record);
+  Nan::SetPrototypeMethod(
+      tpl, "record",
+      MeterMethod<JsPercentileTimer, args::Duration<true>,
+                  &JsPercentileTimer::RecordNanos>);
+  Nan::SetPrototypeMethod(tpl, "timePromise", TimePromise);
   Nan::SetPrototypeMethod(tpl, "percentile", Percentile);
   Nan::SetPrototypeMethod(tpl, "count", Count);
   Nan::SetPrototypeMethod(tpl, "totalTime", TotalTime);
+  JsMeter::SetPrototypeMethods(tpl);
+  JsMeter::SetRollingWindowMethod(tpl, RollingWindow::Kind::kTimer);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -1181,50 +1815,34 @@ NAN_METHOD(JsPercentileTimer::New) {
   }
 }
 
-NAN_METHOD(JsPercentileTimer::Record) {
-  auto t = Nan::ObjectWrap::Unwrap<JsPercentileTimer>(info.This());
-  auto context = Nan::GetCurrentContext();
-  int64_t seconds = 0, nanos = 0;
-  if (info.Length() == 1 && info[0]->IsArray()) {
-    auto hrtime = info[0].As<v8::Array>();
-    if (hrtime->Length() == 2) {
-      seconds =
-          Nan::To<int64_t>(hrtime->Get(context, 0).ToLocalChecked()).FromJust();
-      nanos =
-          Nan::To<int64_t>(hrtime->Get(context, 1).ToLocalChecked()).FromJust();
-    } else {
-      Nan::ThrowError(
-          "Expecting an array of two elements: seconds, nanos. See "
-          "process.hrtime()");
-    }
-  } else if (info.Length() == 2) {
-    seconds = (long)(info[0]->IsUndefined()
-                         ? 0
-                         : info[0]->NumberValue(context).FromJust());
-    nanos = (long)(info[1]->IsUndefined()
-                       ? 0
-                       : info[1]->NumberValue(context).FromJust());
-  } else {
-    Nan::ThrowError("Expecting two numbers: seconds and nanoseconds");
-  }
-
-  t->perc_timer_->Record(std::chrono::nanoseconds(seconds * NANOS + nanos));
+void JsPercentileTimer::RecordNanos(int64_t nanos) {
+  perc_timer_->Record(std::chrono::nanoseconds(nanos));
+  RecordWindow(nanos / 1e9);
 }
 
 NAN_METHOD(JsPercentileTimer::TotalTime) {
-  auto tmr = Nan::ObjectWrap::Unwrap<JsPercentileTimer>(info.This());
+  auto tmr = JsMeter::Active<JsPercentileTimer>(info);
+  if (tmr == nullptr) {
+    return;
+  }
   double totalTime = tmr->perc_timer_->TotalTime() / 1e9;
   info.GetReturnValue().Set(totalTime);
 }
 
 NAN_METHOD(JsPercentileTimer::Count) {
-  auto tmr = Nan::ObjectWrap::Unwrap<JsPercentileTimer>(info.This());
+  auto tmr = JsMeter::Active<JsPercentileTimer>(info);
+  if (tmr == nullptr) {
+    return;
+  }
   double count = tmr->perc_timer_->Count();
   info.GetReturnValue().Set(count);
 }
 
 NAN_METHOD(JsPercentileTimer::Percentile) {
-  auto t = Nan::ObjectWrap::Unwrap<JsPercentileTimer>(info.This());
+  auto t = JsMeter::Active<JsPercentileTimer>(info);
+  if (t == nullptr) {
+    return;
+  }
   if (info.Length() == 0) {
     Nan::ThrowError(
         "Need the percentile to compute as a number from 0.0 to 100.0");
@@ -1235,9 +1853,42 @@ NAN_METHOD(JsPercentileTimer::Percentile) {
   info.GetReturnValue().Set(value);
 }
 
+NAN_METHOD(JsPercentileTimer::TimePromise) {
+  ::TimePromise<JsPercentileTimer>(info);
+}
+
+void JsPercentileTimer::RecordSettled(int64_t nanos, const char* outcome) {
+  auto duration = std::chrono::nanoseconds(nanos);
+  RecordWindow(nanos / 1e9);
+  if (outcome == nullptr) {
+    perc_timer_->Record(duration);
+    return;
+  }
+  auto success = outcome[0] == 's';
+  auto& sibling = success ? success_ : failure_;
+  if (!sibling) {
+    sibling = std::make_shared<atlas::meter::PercentileTimer>(
+        atlas_registry(),
+        id_->WithTag(atlas::meter::Tag::of("result", outcome)));
+  }
+  sibling->Record(duration);
+}
+
 JsPercentileTimer::JsPercentileTimer(IdPtr id)
-    : perc_timer_{std::make_shared<atlas::meter::PercentileTimer>(
-          atlas_registry(), id)} {}
+    : JsMeter{MeterKind::kPercentileTimer, id} {
+  AcquireMeters();
+}
+
+void JsPercentileTimer::AcquireMeters() {
+  perc_timer_ =
+      std::make_shared<atlas::meter::PercentileTimer>(atlas_registry(), id_);
+}
+
+void JsPercentileTimer::ReleaseMeters() {
+  perc_timer_.reset();
+  success_.reset();
+  failure_.reset();
+}
 
 NAN_MODULE_INIT(JsPercentileDistSummary::Init) {
   Nan::HandleScope scope;
@@ -1248,10 +1899,14 @@ NAN_MODULE_INIT(JsPercentileDistSummary::Init) {
   tpl->InstanceTemplate()->SetInternalFieldCount(1);
 
   // Prototype
-  Nan::SetPrototypeMethod(tpl, "record", Record);
+  Nan::SetPrototypeMethod(
+      tpl, "record",
+      MeterMethod<JsPercentileDistSummary, args::Number<int64_t>,
+                  &JsPercentileDistSummary::RecordValue>);
   Nan::SetPrototypeMethod(tpl, "percentile", Percentile);
   Nan::SetPrototypeMethod(tpl, "count", Count);
   Nan::SetPrototypeMethod(tpl, "totalAmount", TotalAmount);
+  JsMeter::SetPrototypeMethods(tpl);
 
   auto context = Nan::GetCurrentContext();
   constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
@@ -1270,29 +1925,33 @@ NAN_METHOD(JsPercentileDistSummary::New) {
   }
 }
 
-NAN_METHOD(JsPercentileDistSummary::Record) {
-  auto t = Nan::ObjectWrap::Unwrap<JsPercentileDistSummary>(info.This());
-  auto value = static_cast<int64_t>(
-      info[0]->IsUndefined()
-          ? 0
-          : info[0]->NumberValue(Nan::GetCurrentContext()).FromJust());
-  t->perc_dist_summary_->Record(value);
+void JsPercentileDistSummary::RecordValue(int64_t value) {
+  perc_dist_summary_->Record(value);
 }
 
 NAN_METHOD(JsPercentileDistSummary::Count) {
-  auto d = Nan::ObjectWrap::Unwrap<JsPercentileDistSummary>(info.This());
+  auto d = JsMeter::Active<JsPercentileDistSummary>(info);
+  if (d == nullptr) {
+    return;
+  }
   auto value = static_cast<double>(d->perc_dist_summary_->Count());
   info.GetReturnValue().Set(value);
 }
 
 NAN_METHOD(JsPercentileDistSummary::TotalAmount) {
-  auto d = Nan::ObjectWrap::Unwrap<JsPercentileDistSummary>(info.This());
+  auto d = JsMeter::Active<JsPercentileDistSummary>(info);
+  if (d == nullptr) {
+    return;
+  }
   auto value = static_cast<double>(d->perc_dist_summary_->TotalAmount());
   info.GetReturnValue().Set(value);
 }
 
 NAN_METHOD(JsPercentileDistSummary::Percentile) {
-  auto d = Nan::ObjectWrap::Unwrap<JsPercentileDistSummary>(info.This());
+  auto d = JsMeter::Active<JsPercentileDistSummary>(info);
+  if (d == nullptr) {
+    return;
+  }
   if (info.Length() == 0) {
     Nan::ThrowError(
         "Need the percentile to compute as a number from 0.0 to 100.0");
@@ -1304,6 +1963,116 @@ NAN_METHOD(JsPercentileDistSummary::Percentile) {
 }
 
 JsPercentileDistSummary::JsPercentileDistSummary(IdPtr id)
-    : perc_dist_summary_{
-          std::make_shared<atlas::meter::PercentileDistributionSummary>(
-              atlas_registry(), id)} {}
+    : JsMeter{MeterKind::kPercentileDistSummary, id} {
+  AcquireMeters();
+}
+
+void JsPercentileDistSummary::AcquireMeters() {
+  perc_dist_summary_ =
+      std::make_shared<atlas::meter::PercentileDistributionSummary>(
+          atlas_registry(), id_);
+}
+
+void JsPercentileDistSummary::ReleaseMeters() { perc_dist_summary_.reset(); }
+
+NAN_MODULE_INIT(JsMeasurementsCursor::Init) {
+  Nan::HandleScope scope;
+
+  // Prepare constructor template
+  Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
+  tpl->SetClassName(Nan::New("JsMeasurementsCursor").ToLocalChecked());
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  // Prototype
+  Nan::SetPrototypeMethod(tpl, "next", Next);
+  Nan::SetPrototypeMethod(tpl, "done", Done);
+  Nan::SetPrototypeMethod(tpl, "size", Size);
+  Nan::SetPrototypeMethod(tpl, "close", Close);
+
+  auto context = Nan::GetCurrentContext();
+  constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
+  Nan::Set(target, Nan::New("JsMeasurementsCursor").ToLocalChecked(),
+           tpl->GetFunction(context).ToLocalChecked());
+}
+
+constexpr uint32_t kDefaultPageSize = 1000;
+
+NAN_METHOD(JsMeasurementsCursor::New) {
+  if (info.IsConstructCall()) {
+    // Invoked as constructor: `new JsMeasurementsCursor(pageSize)`
+    auto page_size = kDefaultPageSize;
+    if (info.Length() > 0 && info[0]->IsNumber()) {
+      auto n = Nan::To<double>(info[0]).FromJust();
+      if (n >= 1) {
+        page_size = static_cast<uint32_t>(n);
+      }
+    }
+    auto obj = new JsMeasurementsCursor(page_size);
+    obj->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  } else {
+    Nan::ThrowError("not implemented");
+  }
+}
+
+// returns the next page of measurements, or an empty array once the
+// snapshot has been exhausted. Each page is built in its own scope so only
+// the page being returned is live on the V8 heap
+NAN_METHOD(JsMeasurementsCursor::Next) {
+  auto cursor = Nan::ObjectWrap::Unwrap<JsMeasurementsCursor>(info.This());
+  auto page_size = cursor->page_size_;
+  if (info.Length() > 0 && info[0]->IsNumber()) {
+    auto n = Nan::To<double>(info[0]).FromJust();
+    if (n >= 1) {
+      page_size = static_cast<uint32_t>(n);
+    }
+  }
+
+  Nan::EscapableHandleScope scope;
+  auto context = Nan::GetCurrentContext();
+  const auto& snapshot = cursor->measurements_;
+  auto remaining = snapshot.size() - cursor->pos_;
+  auto n = remaining < page_size ? remaining : page_size;
+  auto page = Nan::New<v8::Array>(static_cast<int>(n));
+  auto name = Nan::New("name").ToLocalChecked();
+  for (size_t i = 0; i < n; ++i) {
+    const auto& m = snapshot[cursor->pos_ + i];
+    page->Set(context, static_cast<uint32_t>(i),
+              measurementToObject(context, cursor->common_tags_, name, m))
+        .FromJust();
+  }
+  cursor->pos_ += n;
+  if (cursor->pos_ == snapshot.size()) {
+    // release the native snapshot as soon as possible
+    cursor->Release();
+  }
+  info.GetReturnValue().Set(scope.Escape(page));
+}
+
+NAN_METHOD(JsMeasurementsCursor::Done) {
+  auto cursor = Nan::ObjectWrap::Unwrap<JsMeasurementsCursor>(info.This());
+  info.GetReturnValue().Set(cursor->pos_ >= cursor->measurements_.size());
+}
+
+NAN_METHOD(JsMeasurementsCursor::Size) {
+  auto cursor = Nan::ObjectWrap::Unwrap<JsMeasurementsCursor>(info.This());
+  info.GetReturnValue().Set(static_cast<double>(cursor->size_));
+}
+
+NAN_METHOD(JsMeasurementsCursor::Close) {
+  auto cursor = Nan::ObjectWrap::Unwrap<JsMeasurementsCursor>(info.This());
+  cursor->Release();
+}
+
+void JsMeasurementsCursor::Release() {
+  Measurements empty;
+  measurements_.swap(empty);
+  pos_ = 0;
+}
+
+JsMeasurementsCursor::JsMeasurementsCursor(uint32_t page_size)
+    : measurements_{atlas_registry()->measurements()},
+      common_tags_{atlas_client().GetConfig()->CommonTags()},
+      page_size_{page_size},
+      pos_{0},
+      size_{measurements_.size()} {}
@@ -9,15 +9,25 @@
 #include <atlas/meter/percentile_dist_summary.h>
 #include <atlas/meter/percentile_timer.h>
 #include <nan.h>
+#include "fast_calls.h"
+#include "js_meter.h"
+#include "lazy_gauges.h"
+#include "sampler.h"
 
 // enable/disable development mode
 NAN_METHOD(set_dev_mode);
 
+// limit the distinct tag combinations per metric name, 0 for no limit
+NAN_METHOD(set_cardinality_limit);
+
 // perform validation checks on name, tags
 NAN_METHOD(validate_name_tags);
 
 // get an array of measurements intended for the main publish pipeline
 NAN_METHOD(measurements);
+
+// get a cursor that returns the measurements in fixed-size pages
+NAN_METHOD(measurements_cursor);
 //
 // get the current config
 NAN_METHOD(config);
@@ -37,6 +47,9 @@ NAN_METHOD(interval_counter);
 // get a timer
 NAN_METHOD(timer);
 
+// get a timer that only records a sample of the events
+NAN_METHOD(sampled_timer);
+
 // get a long task timer
 NAN_METHOD(long_task_timer);
 
@@ -46,6 +59,15 @@ NAN_METHOD(gauge);
 // get a max gauge
 NAN_METHOD(max_gauge);
 
+// get a gauge reporting the seconds since it was last updated
+NAN_METHOD(age_gauge);
+
+// get a gauge whose value is computed by a function at snapshot time
+NAN_METHOD(function_gauge);
+
+// how often lazy gauges are refreshed for the publisher
+NAN_METHOD(set_lazy_gauge_interval);
+
 // get a distribution summary
 NAN_METHOD(dist_summary);
 
@@ -65,7 +87,7 @@ NAN_METHOD(percentile_timer);
 NAN_METHOD(percentile_dist_summary);
 
 // wrapper for a counter
-class JsCounter : public Nan::ObjectWrap {
+class JsCounter : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -74,14 +96,22 @@ class JsCounter : public Nan::ObjectWrap {
   explicit JsCounter(atlas::meter::IdPtr id);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Increment);
-  static NAN_METHOD(Add);
   static NAN_METHOD(Count);
 
+  // increment([n]) and add([n])
+  void AddAmount(long amount);
+
+  // fast API overloads of increment() and add()
+  static void FastIncrement(v8::Local<v8::Object> receiver);
+  static void FastAdd(v8::Local<v8::Object> receiver, double value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::Counter> counter_;
 };
 
-class JsDCounter : public Nan::ObjectWrap {
+class JsDCounter : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -90,33 +120,86 @@ class JsDCounter : public Nan::ObjectWrap {
   explicit JsDCounter(atlas::meter::IdPtr id);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Increment);
-  static NAN_METHOD(Add);
   static NAN_METHOD(Count);
 
+  void AddAmount(double amount);
+
+  static void FastIncrement(v8::Local<v8::Object> receiver);
+  static void FastAdd(v8::Local<v8::Object> receiver, double value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::DCounter> counter_;
 };
 
 // wrapper for a timer
-class JsTimer : public Nan::ObjectWrap {
+class JsTimer : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
 
+  // record a settled promise, optionally into a sibling tagged with the
+  // outcome
+  void RecordSettled(int64_t nanos, const char* outcome);
+
  private:
   explicit JsTimer(atlas::meter::IdPtr id);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Record);
   static NAN_METHOD(TimeThis);
+  static NAN_METHOD(TimePromise);
   static NAN_METHOD(TotalTime);
   static NAN_METHOD(Count);
 
+  // fast API overload of record(seconds, nanos)
+  static void FastRecord(v8::Local<v8::Object> receiver, double seconds,
+                         double nanos);
+
+  // record(), timeThis() and the fast API overload
+  void RecordNanos(int64_t nanos);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::Timer> timer_;
+  std::shared_ptr<atlas::meter::Timer> success_;
+  std::shared_ptr<atlas::meter::Timer> failure_;
+};
+
+// wrapper for a timer that records 1 in N events, scaled by N
+class JsSampledTimer : public JsMeter {
+ public:
+  static NAN_MODULE_INIT(Init);
+  static Nan::Persistent<v8::Function> constructor;
+
+ private:
+  JsSampledTimer(atlas::meter::IdPtr id, uint32_t factor);
+
+  static NAN_METHOD(New);
+  static NAN_METHOD(Record);
+  static NAN_METHOD(TimeThis);
+  static NAN_METHOD(Start);
+  static NAN_METHOD(Stop);
+  static NAN_METHOD(TotalTime);
+  static NAN_METHOD(Count);
+
+  void RecordSample(int64_t nanos) noexcept;
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
+  // the statistics of a timer, kept as separate meters so each sample can
+  // be scaled by the sampling factor
+  std::shared_ptr<atlas::meter::Counter> count_;
+  std::shared_ptr<atlas::meter::DCounter> total_time_;
+  std::shared_ptr<atlas::meter::DCounter> total_of_squares_;
+  std::shared_ptr<atlas::meter::Gauge<double>> max_;
+  Sampler sampler_;
 };
 
 // wrapper for a long task timer
-class JsLongTaskTimer : public Nan::ObjectWrap {
+class JsLongTaskTimer : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -130,11 +213,14 @@ class JsLongTaskTimer : public Nan::ObjectWrap {
   static NAN_METHOD(Duration);
   static NAN_METHOD(ActiveTasks);
 
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::LongTaskTimer> timer_;
 };
 
 // wrapper for a gauge
-class JsGauge : public Nan::ObjectWrap {
+class JsGauge : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -143,13 +229,19 @@ class JsGauge : public Nan::ObjectWrap {
   JsGauge(atlas::meter::IdPtr id);
   static NAN_METHOD(New);
   static NAN_METHOD(Value);
-  static NAN_METHOD(Update);
+
+  static void FastUpdate(v8::Local<v8::Object> receiver, double value);
+
+  void UpdateValue(double value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
 
   std::shared_ptr<atlas::meter::Gauge<double>> gauge_;
 };
 
 // wrapper for a max gauge
-class JsMaxGauge : public Nan::ObjectWrap {
+class JsMaxGauge : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -158,13 +250,58 @@ class JsMaxGauge : public Nan::ObjectWrap {
   explicit JsMaxGauge(atlas::meter::IdPtr id);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Update);
   static NAN_METHOD(Value);
 
+  static void FastUpdate(v8::Local<v8::Object> receiver, double value);
+
+  void UpdateValue(double value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::Gauge<double>> max_gauge_;
 };
 
-class JsDistSummary : public Nan::ObjectWrap {
+// wrapper for a gauge that reports its age, computed when needed
+class JsAgeGauge : public JsMeter {
+ public:
+  static NAN_MODULE_INIT(Init);
+  static Nan::Persistent<v8::Function> constructor;
+
+ private:
+  explicit JsAgeGauge(atlas::meter::IdPtr id);
+
+  static NAN_METHOD(New);
+  static NAN_METHOD(Update);
+  static NAN_METHOD(Value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
+  std::shared_ptr<AgeGauge> age_gauge_;
+};
+
+// wrapper for a gauge that calls a function to get its value
+class JsFunctionGauge : public JsMeter {
+ public:
+  static NAN_MODULE_INIT(Init);
+  static Nan::Persistent<v8::Function> constructor;
+
+ private:
+  JsFunctionGauge(atlas::meter::IdPtr id, v8::Local<v8::Function> function);
+
+  static NAN_METHOD(New);
+  static NAN_METHOD(Value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
+  // kept to create the gauge again after an expiry
+  Nan::Global<v8::Function> function_;
+  std::shared_ptr<FunctionGauge> function_gauge_;
+};
+
+class JsDistSummary : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -173,14 +310,20 @@ class JsDistSummary : public Nan::ObjectWrap {
   explicit JsDistSummary(atlas::meter::IdPtr id);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Record);
   static NAN_METHOD(TotalAmount);
   static NAN_METHOD(Count);
 
+  static void FastRecord(v8::Local<v8::Object> receiver, double value);
+
+  void RecordValue(int64_t value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::DistributionSummary> dist_summary_;
 };
 
-class JsBucketCounter : public Nan::ObjectWrap {
+class JsBucketCounter : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -190,12 +333,17 @@ class JsBucketCounter : public Nan::ObjectWrap {
                            atlas::meter::BucketFunction bucket_function);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Record);
 
+  void RecordValue(uint64_t value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
+  atlas::meter::BucketFunction bucket_function_;
   std::shared_ptr<atlas::meter::BucketCounter> bucket_counter_;
 };
 
-class JsBucketDistSummary : public Nan::ObjectWrap {
+class JsBucketDistSummary : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -205,44 +353,68 @@ class JsBucketDistSummary : public Nan::ObjectWrap {
                                atlas::meter::BucketFunction bucket_function);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Record);
 
+  void RecordValue(uint64_t value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
+  atlas::meter::BucketFunction bucket_function_;
   std::shared_ptr<atlas::meter::BucketDistributionSummary> bucket_dist_summary_;
 };
 
-class JsBucketTimer : public Nan::ObjectWrap {
+class JsBucketTimer : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
 
+  void RecordSettled(int64_t nanos, const char* outcome);
+
  private:
   explicit JsBucketTimer(atlas::meter::IdPtr id,
                          atlas::meter::BucketFunction bucket_function);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Record);
+  static NAN_METHOD(TimePromise);
+
+  void RecordNanos(int64_t nanos);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
 
+  atlas::meter::BucketFunction bucket_function_;
   std::shared_ptr<atlas::meter::BucketTimer> bucket_timer_;
+  std::shared_ptr<atlas::meter::BucketTimer> success_;
+  std::shared_ptr<atlas::meter::BucketTimer> failure_;
 };
 
-class JsPercentileTimer : public Nan::ObjectWrap {
+class JsPercentileTimer : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
 
+  void RecordSettled(int64_t nanos, const char* outcome);
+
  private:
   explicit JsPercentileTimer(atlas::meter::IdPtr id);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Record);
+  static NAN_METHOD(TimePromise);
   static NAN_METHOD(Percentile);
   static NAN_METHOD(TotalTime);
   static NAN_METHOD(Count);
 
+  void RecordNanos(int64_t nanos);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::PercentileTimer> perc_timer_;
+  std::shared_ptr<atlas::meter::PercentileTimer> success_;
+  std::shared_ptr<atlas::meter::PercentileTimer> failure_;
 };
 
-class JsPercentileDistSummary : public Nan::ObjectWrap {
+class JsPercentileDistSummary : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -251,16 +423,20 @@ class JsPercentileDistSummary : public Nan::ObjectWrap {
   explicit JsPercentileDistSummary(atlas::meter::IdPtr id);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Record);
   static NAN_METHOD(Percentile);
   static NAN_METHOD(TotalAmount);
   static NAN_METHOD(Count);
 
+  void RecordValue(int64_t value);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::PercentileDistributionSummary>
       perc_dist_summary_;
 };
 
-class JsIntervalCounter : public Nan::ObjectWrap {
+class JsIntervalCounter : public JsMeter {
  public:
   static NAN_MODULE_INIT(Init);
   static Nan::Persistent<v8::Function> constructor;
@@ -269,10 +445,37 @@ class JsIntervalCounter : public Nan::ObjectWrap {
   explicit JsIntervalCounter(atlas::meter::IdPtr id);
 
   static NAN_METHOD(New);
-  static NAN_METHOD(Increment);
-  static NAN_METHOD(Add);
   static NAN_METHOD(Count);
   static NAN_METHOD(SecondsSinceLastUpdate);
 
+  void AddAmount(long amount);
+
+  void ReleaseMeters() override;
+  void AcquireMeters() override;
+
   std::shared_ptr<atlas::meter::IntervalCounter> counter_;
 };
+
+// paged view over a snapshot of the registry measurements
+class JsMeasurementsCursor : public Nan::ObjectWrap {
+ public:
+  static NAN_MODULE_INIT(Init);
+  static Nan::Persistent<v8::Function> constructor;
+
+ private:
+  explicit JsMeasurementsCursor(uint32_t page_size);
+
+  static NAN_METHOD(New);
+  static NAN_METHOD(Next);
+  static NAN_METHOD(Done);
+  static NAN_METHOD(Size);
+  static NAN_METHOD(Close);
+
+  void Release();
+
+  atlas::meter::Measurements measurements_;
+  atlas::meter::Tags common_tags_;
+  uint32_t page_size_;
+  size_t pos_;
+  size_t size_;
+};
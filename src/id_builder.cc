@@ -0,0 +1,60 @@
+#include "id_builder.h"
+#include <atlas/meter/validation.h>
+#include <sstream>
+
+using atlas::meter::Tags;
+using atlas::meter::ValidationIssue;
+
+std::ostream& operator<<(std::ostream& os, const Tags& tags) {
+  os << '{';
+  auto first = true;
+  for (const auto& kv : tags) {
+    if (first) {
+      first = false;
+    } else {
+      os << ", ";
+    }
+    os << kv.first.get() << '=' << kv.second.get();
+  }
+  os << '}';
+  return os;
+}
+
+bool add_tag(const std::string& key, const std::string& value, Tags* tags,
+             std::string* err_msg) {
+  if (key.empty()) {
+    *err_msg = "Cannot have an empty key when specifying tags";
+    return false;
+  }
+  if (value.empty()) {
+    *err_msg = "Cannot have an empty value for key '" + key +
+               "' when specifying tags";
+    return false;
+  }
+  tags->add(key.c_str(), value.c_str());
+  return true;
+}
+
+std::string validate_id(const std::string& name, const Tags& tags,
+                        bool* has_errors) {
+  *has_errors = false;
+  Tags to_check{tags};
+  to_check.add("name", name.c_str());
+
+  auto res = atlas::meter::AnalyzeTags(to_check);
+  // no warnings or errors found
+  if (res.empty()) {
+    return std::string();
+  }
+
+  std::ostringstream err_msg;
+  err_msg << "[name:'" << name << "', tags:" << tags << "]:\n";
+  for (const auto& issue : res) {
+    if (issue.level == ValidationIssue::Level::ERROR) {
+      *has_errors = true;
+    }
+
+    err_msg << '\t' << issue.ToString() << '\n';
+  }
+  return err_msg.str();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atlas/meter/id.h>
+#include <ostream>
+#include <string>
+
+// the parts of building an id that do not depend on V8, so they can be
+// benchmarked and tested without embedding node
+
+// add key=value to tags. Returns false, setting err_msg, if either is empty
+bool add_tag(const std::string& key, const std::string& value,
+             atlas::meter::Tags* tags, std::string* err_msg);
+
+// run the full validation on a name and its tags. Returns a description of
+// any issues found, setting has_errors if at least one of them is an error
+// and not just a warning
+std::string validate_id(const std::string& name,
+                        const atlas::meter::Tags& tags, bool* has_errors);
+
+std::ostream& operator<<(std::ostream& os, const atlas::meter::Tags& tags);
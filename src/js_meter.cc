@@ -0,0 +1,166 @@
+#include "js_meter.h"
+#include "utils.h"
+#include <algorithm>
+
+static JsMeter* live_wrappers = nullptr;
+
+// the sweep runs on an unref'd timer, so it never keeps the process alive
+static uv_timer_t sweep_timer;
+static bool sweep_timer_started = false;
+static int64_t idle_ttl_ms = 0;
+
+static constexpr uint64_t kMinSweepMs = 1000;
+
+JsMeter::JsMeter(MeterKind kind, atlas::meter::IdPtr id)
+    : id_{std::move(id)}, kind_{kind}, entry_{track_meter(kind, id_)} {
+  next_ = live_wrappers;
+  if (next_ != nullptr) {
+    next_->prev_ = this;
+  }
+  live_wrappers = this;
+}
+
+JsMeter::~JsMeter() {
+  if (prev_ != nullptr) {
+    prev_->next_ = next_;
+  } else {
+    live_wrappers = next_;
+  }
+  if (next_ != nullptr) {
+    next_->prev_ = prev_;
+  }
+  if (!released_) {
+    untrack_wrapper(entry_);
+  }
+}
+
+void JsMeter::Release() {
+  if (released_) {
+    return;
+  }
+  released_ = true;
+  ReleaseMeters();
+  untrack_wrapper(entry_);
+}
+
+// the memory of the meter is reported to V8 later when called from a fast
+// API call. The expiry gave up the series' cardinality slot, so it is
+// admitted again, or folded into the overflow id when its slot was taken
+bool JsMeter::Reacquire(bool js_allowed) {
+  if (disposed_) {
+    return false;
+  }
+  id_ = readmit_series(id_);
+  entry_ = track_meter(kind_, id_, js_allowed);
+  AcquireMeters();
+  released_ = false;
+  return true;
+}
+
+void JsMeter::SetPrototypeMethods(v8::Local<v8::FunctionTemplate> tpl) {
+  Nan::SetPrototypeMethod(tpl, "dispose", Dispose);
+  Nan::SetPrototypeMethod(tpl, "isDisposed", IsDisposed);
+}
+
+void JsMeter::SetRollingWindowMethod(v8::Local<v8::FunctionTemplate> tpl,
+                                     RollingWindow::Kind kind) {
+  Nan::SetPrototypeMethod(tpl, "rollingWindow",
+                          kind == RollingWindow::Kind::kTimer ? TimerWindow
+                                                              : CounterWindow);
+}
+
+static constexpr int64_t kDefaultWindowMs = 60 * 1000;
+static constexpr size_t kDefaultWindowBuckets = 12;
+static constexpr size_t kMaxWindowBuckets = 1000;
+
+void JsMeter::EnableWindow(const Nan::FunctionCallbackInfo<v8::Value>& info,
+                           RollingWindow::Kind kind) {
+  auto meter = Nan::ObjectWrap::Unwrap<JsMeter>(info.This());
+  // a second call shares the window created by the first one
+  if (!meter->window_) {
+    auto window_ms = kDefaultWindowMs;
+    auto buckets = kDefaultWindowBuckets;
+    if (info.Length() > 0 && info[0]->IsObject()) {
+      auto options = info[0].As<v8::Object>();
+      auto ms = Nan::Get(options, Nan::New("windowMs").ToLocalChecked());
+      if (!ms.IsEmpty() && ms.ToLocalChecked()->IsNumber()) {
+        window_ms = std::max<int64_t>(
+            Nan::To<int64_t>(ms.ToLocalChecked()).FromJust(), 1);
+      }
+      auto n = Nan::Get(options, Nan::New("buckets").ToLocalChecked());
+      if (!n.IsEmpty() && n.ToLocalChecked()->IsNumber()) {
+        auto b = Nan::To<int64_t>(n.ToLocalChecked()).FromJust();
+        buckets = static_cast<size_t>(
+            std::min<int64_t>(std::max<int64_t>(b, 1), kMaxWindowBuckets));
+      }
+    }
+    meter->window_ = std::make_shared<RollingWindow>(
+        kind, window_ms, buckets, rolling_window_now());
+  }
+  info.GetReturnValue().Set(JsRollingWindow::NewInstance(meter->window_));
+}
+
+NAN_METHOD(JsMeter::CounterWindow) {
+  EnableWindow(info, RollingWindow::Kind::kCounter);
+}
+
+NAN_METHOD(JsMeter::TimerWindow) {
+  EnableWindow(info, RollingWindow::Kind::kTimer);
+}
+
+NAN_METHOD(JsMeter::Dispose) {
+  auto meter = Nan::ObjectWrap::Unwrap<JsMeter>(info.This());
+  if (meter->disposed_) {
+    return;
+  }
+  meter->disposed_ = true;
+  if (meter->released_) {
+    // expired, the sweep already took care of its entry
+    return;
+  }
+  meter->Release();
+  finish_meter(meter->entry_);
+}
+
+NAN_METHOD(JsMeter::IsDisposed) {
+  auto meter = Nan::ObjectWrap::Unwrap<JsMeter>(info.This());
+  info.GetReturnValue().Set(meter->disposed_);
+}
+
+void JsMeter::Sweep(uv_timer_t* handle) {
+  auto now = static_cast<int64_t>(uv_now(handle->loop));
+  for (auto w = live_wrappers; w != nullptr; w = w->next_) {
+    if (!w->released_ && now - w->entry_->last_used > idle_ttl_ms) {
+      w->Release();
+    }
+  }
+  expire_meters(now, idle_ttl_ms);
+}
+
+void JsMeter::SetIdleTtl(uint64_t ttl_millis) {
+  idle_ttl_ms = static_cast<int64_t>(ttl_millis);
+  if (ttl_millis == 0) {
+    if (sweep_timer_started) {
+      uv_timer_stop(&sweep_timer);
+    }
+    return;
+  }
+
+  // meters expire between ttl and 1.5 * ttl after their last use
+  auto period = std::max(ttl_millis / 2, kMinSweepMs);
+  if (!sweep_timer_started) {
+    uv_timer_init(uv_default_loop(), &sweep_timer);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&sweep_timer));
+    sweep_timer_started = true;
+  }
+  uv_timer_start(&sweep_timer, Sweep, period, period);
+}
+
+NAN_METHOD(set_meter_ttl) {
+  if (info.Length() == 1 && info[0]->IsNumber()) {
+    auto ttl = Nan::To<double>(info[0]).FromJust();
+    JsMeter::SetIdleTtl(ttl > 0 ? static_cast<uint64_t>(ttl) : 0);
+  } else {
+    Nan::ThrowError("setMeterTtl() expects a number of milliseconds");
+  }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "memory_stats.h"
+#include "rolling_window.h"
+#include <atlas/meter/id.h>
+#include <nan.h>
+
+// base class for the JS wrappers of meters. A wrapper can be disposed, or
+// expire after not being used for the configured idle ttl. Either way it
+// drops its references to the native meter. A disposed wrapper's methods
+// become no-ops, an expired one gets its meter back on its next use
+class JsMeter : public Nan::ObjectWrap {
+ public:
+  // unwrap info.This() and mark it as used, or nullptr if the wrapper was
+  // disposed
+  template <typename T>
+  static T* Active(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+    return Active<T>(info.This(), true);
+  }
+
+  // same for the receiver of a fast API call. Does not touch the V8 heap
+  // unless js_allowed
+  template <typename T>
+  static T* Active(v8::Local<v8::Object> receiver, bool js_allowed = false) {
+    auto meter = Nan::ObjectWrap::Unwrap<T>(receiver);
+    if (meter->released_ && !meter->Reacquire(js_allowed)) {
+      return nullptr;
+    }
+    meter->entry_->last_used =
+        static_cast<int64_t>(uv_now(uv_default_loop()));
+    return meter;
+  }
+
+  // add dispose() and isDisposed() to a wrapper's prototype
+  static void SetPrototypeMethods(v8::Local<v8::FunctionTemplate> tpl);
+
+  // add rollingWindow({windowMs, buckets}) to a wrapper's prototype. It
+  // starts keeping a rolling window of what the meter records, and returns
+  // a JsRollingWindow to query it
+  static void SetRollingWindowMethod(v8::Local<v8::FunctionTemplate> tpl,
+                                     RollingWindow::Kind kind);
+
+  // wrappers not used for ttl_millis expire, 0 disables expiration
+  static void SetIdleTtl(uint64_t ttl_millis);
+
+ protected:
+  JsMeter(MeterKind kind, atlas::meter::IdPtr id);
+  ~JsMeter() override;
+
+  // drop the references to the native meters
+  virtual void ReleaseMeters() = 0;
+  // get the native meters for id_ again, after the wrapper expired
+  virtual void AcquireMeters() = 0;
+
+  // a single branch unless rollingWindow() was called
+  void RecordWindow(double value) noexcept {
+    if (window_) {
+      window_->Record(value, rolling_window_now());
+    }
+  }
+
+  atlas::meter::IdPtr id_;
+
+ private:
+  static NAN_METHOD(Dispose);
+  static NAN_METHOD(IsDisposed);
+  static NAN_METHOD(CounterWindow);
+  static NAN_METHOD(TimerWindow);
+  static void EnableWindow(const Nan::FunctionCallbackInfo<v8::Value>& info,
+                           RollingWindow::Kind kind);
+  static void Sweep(uv_timer_t* handle);
+
+  void Release();
+  // undo an expiry, false if the wrapper was disposed
+  bool Reacquire(bool js_allowed);
+
+  MeterKind kind_;
+  MeterEntry* entry_;
+  bool released_ = false;
+  bool disposed_ = false;
+  std::shared_ptr<RollingWindow> window_;
+  // live wrappers, so the sweep can find the idle ones
+  JsMeter* prev_ = nullptr;
+  JsMeter* next_ = nullptr;
+};
+
+// setMeterTtl(millis)
+NAN_METHOD(set_meter_ttl);
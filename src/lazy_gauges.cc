@@ -0,0 +1,124 @@
+#include "lazy_gauges.h"
+#include "self_metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+using atlas::meter::Gauge;
+
+static std::mutex lazy_gauges_mutex;
+static std::vector<std::shared_ptr<LazyGauge>> lazy_gauges;
+
+// a single timer refreshes every lazy gauge so the publisher sees recent
+// values. It is unref'd so it never keeps the process alive
+static uv_timer_t refresh_timer;
+static bool refresh_timer_started = false;
+static uint64_t refresh_interval_ms = 30 * 1000;
+
+int64_t wall_millis() noexcept {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+      .count();
+}
+
+AgeGauge::AgeGauge(std::shared_ptr<Gauge<double>> gauge)
+    : LazyGauge{std::move(gauge)}, last_updated_{wall_millis()} {
+  gauge_->Update(0);
+}
+
+void AgeGauge::Update(int64_t updated_millis) noexcept {
+  last_updated_ = updated_millis;
+  Refresh();
+}
+
+double AgeGauge::Age() const noexcept {
+  return (wall_millis() - last_updated_) / 1000.0;
+}
+
+void AgeGauge::Refresh() { gauge_->Update(Age()); }
+
+FunctionGauge::FunctionGauge(std::shared_ptr<Gauge<double>> gauge,
+                             v8::Local<v8::Function> function)
+    : LazyGauge{std::move(gauge)},
+      callback_{function},
+      async_resource_{"atlas:FunctionGauge"} {}
+
+void FunctionGauge::Refresh() {
+  Nan::HandleScope scope;
+  Nan::TryCatch tc;
+  auto result = callback_.Call(0, nullptr, &async_resource_);
+  if (result.IsEmpty()) {
+    // errors thrown by the user function are ignored, the gauge keeps its
+    // previous value
+    return;
+  }
+  auto value = result.ToLocalChecked();
+  if (value->IsNumber()) {
+    gauge_->Update(value.As<v8::Number>()->Value());
+  }
+}
+
+static void refresh_on_timer(uv_timer_t*) {
+  SelfTimer self_timer{SelfOp::kSampler};
+  refresh_lazy_gauges(true);
+}
+
+static void start_refresh_timer() {
+  uv_timer_init(uv_default_loop(), &refresh_timer);
+  uv_timer_start(&refresh_timer, refresh_on_timer, refresh_interval_ms,
+                 refresh_interval_ms);
+  uv_unref(reinterpret_cast<uv_handle_t*>(&refresh_timer));
+  refresh_timer_started = true;
+}
+
+void register_lazy_gauge(std::shared_ptr<LazyGauge> gauge) {
+  {
+    std::lock_guard<std::mutex> guard{lazy_gauges_mutex};
+    lazy_gauges.emplace_back(std::move(gauge));
+  }
+  if (!refresh_timer_started) {
+    start_refresh_timer();
+  }
+}
+
+void unregister_lazy_gauge(const LazyGauge* gauge) {
+  std::lock_guard<std::mutex> guard{lazy_gauges_mutex};
+  lazy_gauges.erase(
+      std::remove_if(lazy_gauges.begin(), lazy_gauges.end(),
+                     [gauge](const std::shared_ptr<LazyGauge>& g) {
+                       return g.get() == gauge;
+                     }),
+      lazy_gauges.end());
+}
+
+void refresh_lazy_gauges(bool js_thread) {
+  // copy so user callbacks can create new gauges while we iterate. Off the
+  // JS thread only the thread safe gauges are copied: the copy could hold
+  // the last reference to a function gauge, and its callback must be
+  // destroyed on the JS thread
+  std::vector<std::shared_ptr<LazyGauge>> gauges;
+  {
+    std::lock_guard<std::mutex> guard{lazy_gauges_mutex};
+    if (js_thread) {
+      gauges = lazy_gauges;
+    } else {
+      for (const auto& g : lazy_gauges) {
+        if (g->ThreadSafe()) {
+          gauges.push_back(g);
+        }
+      }
+    }
+  }
+  for (const auto& g : gauges) {
+    g->Refresh();
+  }
+}
+
+void set_lazy_gauge_interval(uint64_t millis) {
+  refresh_interval_ms = millis > 0 ? millis : 1;
+  if (refresh_timer_started) {
+    uv_timer_start(&refresh_timer, refresh_on_timer, refresh_interval_ms,
+                   refresh_interval_ms);
+  }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atlas/atlas_client.h>
+#include <nan.h>
+#include <atomic>
+
+// gauges whose value is computed when a snapshot is taken instead of being
+// pushed by a timer per gauge
+class LazyGauge {
+ public:
+  explicit LazyGauge(std::shared_ptr<atlas::meter::Gauge<double>> gauge)
+      : gauge_{std::move(gauge)} {}
+  virtual ~LazyGauge() = default;
+
+  // compute the current value and update the underlying gauge
+  virtual void Refresh() = 0;
+
+  // whether Refresh can be called from a thread other than the JS thread
+  virtual bool ThreadSafe() const noexcept { return false; }
+
+  double Value() const noexcept { return gauge_->Value(); }
+
+ protected:
+  std::shared_ptr<atlas::meter::Gauge<double>> gauge_;
+};
+
+// seconds since the last time Update was called
+class AgeGauge : public LazyGauge {
+ public:
+  explicit AgeGauge(std::shared_ptr<atlas::meter::Gauge<double>> gauge);
+
+  void Refresh() override;
+  bool ThreadSafe() const noexcept override { return true; }
+
+  // timestamp in milliseconds since the epoch
+  void Update(int64_t updated_millis) noexcept;
+  double Age() const noexcept;
+
+ private:
+  std::atomic<int64_t> last_updated_;
+};
+
+// value obtained by calling a JS function
+class FunctionGauge : public LazyGauge {
+ public:
+  FunctionGauge(std::shared_ptr<atlas::meter::Gauge<double>> gauge,
+                v8::Local<v8::Function> function);
+
+  void Refresh() override;
+
+ private:
+  Nan::Callback callback_;
+  Nan::AsyncResource async_resource_;
+};
+
+// start refreshing gauge as part of every snapshot
+void register_lazy_gauge(std::shared_ptr<LazyGauge> gauge);
+
+// stop refreshing gauge
+void unregister_lazy_gauge(const LazyGauge* gauge);
+
+// refresh registered gauges. Gauges that need to call into JS are skipped
+// unless we are on the JS thread
+void refresh_lazy_gauges(bool js_thread);
+
+// how often lazy gauges are refreshed for the background publisher
+void set_lazy_gauge_interval(uint64_t millis);
+
+int64_t wall_millis() noexcept;
@@ -0,0 +1,226 @@
+#include "memory_stats.h"
+#include "cardinality.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using atlas::meter::IdPtr;
+
+static constexpr int kNumKinds = static_cast<int>(MeterKind::kNumKinds);
+
+struct KindInfo {
+  const char* name;
+  // estimated size of the meter held by the registry, excluding its id
+  int64_t bytes;
+};
+
+// rough sizes for atlas-native-client v4: the meter object, its control
+// block and its slot in the registry map. Percentile meters also hold a
+// counter and an id for each of their 276 buckets, created as they are
+// used, counted here as if half of them were in use
+static constexpr KindInfo kKinds[kNumKinds] = {
+    {"counter", 96},
+    {"dcounter", 96},
+    {"intervalCounter", 160},
+    {"timer", 160},
+    {"longTaskTimer", 256},
+    {"gauge", 96},
+    {"maxGauge", 96},
+    {"distSummary", 160},
+    {"bucketCounter", 128},
+    {"bucketDistSummary", 128},
+    {"bucketTimer", 128},
+    {"percentileTimer", 512 + 138 * 256},
+    {"percentileDistSummary", 512 + 138 * 256},
+};
+
+// an Id, its control block and the vector of tags
+static constexpr int64_t kIdBytes = 96;
+static constexpr int64_t kTagBytes = 16;
+// table entry and allocation overhead for an interned string
+static constexpr int64_t kInternOverhead = 48;
+
+struct Usage {
+  int64_t meters = 0;
+  int64_t bytes = 0;
+};
+
+struct MeterKey {
+  const char* name;
+  uint64_t tags;
+  int kind;
+  bool operator==(const MeterKey& other) const noexcept {
+    return name == other.name && tags == other.tags && kind == other.kind;
+  }
+};
+
+struct MeterKeyHash {
+  size_t operator()(const MeterKey& k) const noexcept {
+    auto h = std::hash<const void*>()(k.name);
+    return h ^ (k.tags + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2)) ^
+           static_cast<size_t>(k.kind);
+  }
+};
+
+static std::unordered_map<MeterKey, MeterEntry, MeterKeyHash> meters;
+static std::unordered_set<const char*> strings;
+static Usage string_usage;
+static Usage kind_usage[kNumKinds];
+static std::unordered_map<const char*, Usage> name_usage;
+static int64_t total_bytes = 0;
+// tracked but not reported to V8 yet
+static int64_t unreported_bytes = 0;
+
+static void adjust_external_memory(int64_t bytes) {
+  bytes += unreported_bytes;
+  unreported_bytes = 0;
+  if (bytes != 0) {
+    Nan::AdjustExternalMemory(static_cast<int>(bytes));
+  }
+}
+
+static int64_t track_string(const char* s) {
+  if (!strings.insert(s).second) {
+    return 0;
+  }
+  auto bytes = static_cast<int64_t>(strlen(s)) + 1 + kInternOverhead;
+  string_usage.meters++;
+  string_usage.bytes += bytes;
+  return bytes;
+}
+
+MeterEntry* track_meter(MeterKind kind, const IdPtr& id, bool report_now) {
+  auto k = static_cast<int>(kind);
+  const auto& tags = id->GetTags();
+  auto now = static_cast<int64_t>(uv_now(uv_default_loop()));
+  auto hash = tags_hash(tags);
+  auto inserted = meters.emplace(MeterKey{id->Name(), hash, k},
+                                 MeterEntry{id->Name(), hash, k, 0, now, 0});
+  auto& entry = inserted.first->second;
+  entry.wrappers++;
+  entry.last_used = now;
+  if (!inserted.second) {
+    return &entry;
+  }
+
+  auto bytes = kKinds[k].bytes + kIdBytes +
+               kTagBytes * static_cast<int64_t>(tags.size());
+  entry.bytes = bytes;
+  kind_usage[k].meters++;
+  kind_usage[k].bytes += bytes;
+  auto& by_name = name_usage[id->Name()];
+  by_name.meters++;
+  by_name.bytes += bytes;
+
+  // strings are shared between meters and stay interned, so they are only
+  // reported in total and never given back
+  bytes += track_string(id->Name());
+  for (const auto& kv : tags) {
+    bytes += track_string(kv.first.get());
+    bytes += track_string(kv.second.get());
+  }
+  total_bytes += bytes;
+  if (report_now) {
+    adjust_external_memory(bytes);
+  } else {
+    unreported_bytes += bytes;
+  }
+  return &entry;
+}
+
+void untrack_wrapper(MeterEntry* entry) { entry->wrappers--; }
+
+// remove the entry from the totals, returning the bytes freed. The caller
+// erases it and reports the bytes to V8
+static int64_t forget(const MeterEntry& entry) {
+  kind_usage[entry.kind].meters--;
+  kind_usage[entry.kind].bytes -= entry.bytes;
+  auto by_name = name_usage.find(entry.name);
+  if (--by_name->second.meters == 0) {
+    name_usage.erase(by_name);
+  } else {
+    by_name->second.bytes -= entry.bytes;
+  }
+  forget_series(entry.name, entry.tags_hash);
+  total_bytes -= entry.bytes;
+  return entry.bytes;
+}
+
+void finish_meter(MeterEntry* entry) {
+  if (entry->wrappers > 0) {
+    return;
+  }
+  auto freed = forget(*entry);
+  meters.erase(MeterKey{entry->name, entry->tags_hash, entry->kind});
+  adjust_external_memory(-freed);
+}
+
+void expire_meters(int64_t now, int64_t ttl_millis) {
+  int64_t freed = 0;
+  for (auto it = meters.begin(); it != meters.end();) {
+    const auto& entry = it->second;
+    if (entry.wrappers > 0 || now - entry.last_used <= ttl_millis) {
+      ++it;
+      continue;
+    }
+    freed += forget(entry);
+    it = meters.erase(it);
+  }
+  adjust_external_memory(-freed);
+}
+
+int64_t tracked_bytes() noexcept { return total_bytes; }
+
+static v8::Local<v8::Object> usage_object(const Usage& usage,
+                                          const char* count_key) {
+  auto obj = Nan::New<v8::Object>();
+  Nan::Set(obj, Nan::New(count_key).ToLocalChecked(),
+           Nan::New(static_cast<double>(usage.meters)));
+  Nan::Set(obj, Nan::New("bytes").ToLocalChecked(),
+           Nan::New(static_cast<double>(usage.bytes)));
+  return obj;
+}
+
+NAN_METHOD(memory_stats) {
+  size_t top_n = 20;
+  if (info.Length() > 0 && info[0]->IsNumber()) {
+    auto n = Nan::To<double>(info[0]).FromJust();
+    top_n = n > 0 ? static_cast<size_t>(n) : 0;
+  }
+
+  auto result = Nan::New<v8::Object>();
+  Nan::Set(result, Nan::New("totalBytes").ToLocalChecked(),
+           Nan::New(static_cast<double>(total_bytes)));
+  Nan::Set(result, Nan::New("strings").ToLocalChecked(),
+           usage_object(string_usage, "count"));
+
+  auto types = Nan::New<v8::Object>();
+  for (auto i = 0; i < kNumKinds; ++i) {
+    if (kind_usage[i].meters > 0) {
+      Nan::Set(types, Nan::New(kKinds[i].name).ToLocalChecked(),
+               usage_object(kind_usage[i], "meters"));
+    }
+  }
+  Nan::Set(result, Nan::New("types").ToLocalChecked(), types);
+
+  std::vector<std::pair<const char*, Usage>> names{name_usage.begin(),
+                                                   name_usage.end()};
+  auto n = std::min(top_n, names.size());
+  std::partial_sort(names.begin(), names.begin() + n, names.end(),
+                    [](const std::pair<const char*, Usage>& a,
+                       const std::pair<const char*, Usage>& b) {
+                      return a.second.bytes > b.second.bytes;
+                    });
+  auto names_array = Nan::New<v8::Array>(static_cast<int>(n));
+  for (size_t i = 0; i < n; ++i) {
+    auto entry = usage_object(names[i].second, "meters");
+    Nan::Set(entry, Nan::New("name").ToLocalChecked(),
+             Nan::New(names[i].first).ToLocalChecked());
+    Nan::Set(names_array, static_cast<uint32_t>(i), entry);
+  }
+  Nan::Set(result, Nan::New("names").ToLocalChecked(), names_array);
+  info.GetReturnValue().Set(result);
+}
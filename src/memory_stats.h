@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atlas/meter/id.h>
+#include <nan.h>
+
+// approximate accounting of the memory held outside the V8 heap by the
+// registry, reported to V8 so its GC heuristics and
+// process.memoryUsage().external can see it
+
+enum class MeterKind {
+  kCounter,
+  kDCounter,
+  kIntervalCounter,
+  kTimer,
+  kLongTaskTimer,
+  kGauge,
+  kMaxGauge,
+  kDistSummary,
+  kBucketCounter,
+  kBucketDistSummary,
+  kBucketTimer,
+  kPercentileTimer,
+  kPercentileDistSummary,
+  kNumKinds
+};
+
+// a meter of a given kind and id, as seen by the binding
+struct MeterEntry {
+  const char* name;
+  uint64_t tags_hash;
+  int kind;
+  int64_t bytes;
+  // loop time in milliseconds of the last use by any wrapper
+  int64_t last_used;
+  // live wrappers using this entry
+  int32_t wrappers;
+};
+
+// account for a new wrapper of the meter of the given kind registered for
+// id. Only the first wrapper for a kind and id adds to the totals. Must be
+// called from the JS thread, like the rest of these functions. Without
+// report_now, the bytes are reported to V8 by the next call that reports
+MeterEntry* track_meter(MeterKind kind, const atlas::meter::IdPtr& id,
+                        bool report_now = true);
+
+// a wrapper for entry went away or was disposed
+void untrack_wrapper(MeterEntry* entry);
+
+// the series for entry is finished: forget it now unless other wrappers
+// still use it
+void finish_meter(MeterEntry* entry);
+
+// forget meters no wrapper has used within ttl_millis of now, giving their
+// bytes back to V8 and making room for them in the cardinality limit
+void expire_meters(int64_t now, int64_t ttl_millis);
+
+// total bytes currently reported to V8
+int64_t tracked_bytes() noexcept;
+
+// memoryStats([topN]): {totalBytes, strings: {count, bytes},
+// types: {counter: {meters, bytes}, ...}, names: [{name, meters, bytes}]}
+// with names sorted by bytes, largest first
+NAN_METHOD(memory_stats);
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <nan.h>
+#include <cstdint>
+#include <type_traits>
+
+// Argument signatures of the meter methods. Each one has a value_type and a
+// static Decode(info) returning it, and is picked at compile time by the
+// methods generated in functions.cc. Numbers, the common case, are read
+// straight from the value without the Maybe returning conversions. Invalid
+// arguments throw a JS exception and decode as 0
+namespace args {
+
+constexpr int64_t kNanosPerSecond = 1000L * 1000L * 1000L;
+
+inline int64_t Nanos(int64_t seconds, int64_t nanos) {
+  return seconds * kNanosPerSecond + nanos;
+}
+
+// integers read SMIs without going through a double
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value, T>::type ToNumber(
+    v8::Local<v8::Value> value, T undefined_value) {
+  if (value->IsInt32()) {
+    return static_cast<T>(value.As<v8::Int32>()->Value());
+  }
+  if (value->IsNumber()) {
+    return static_cast<T>(value.As<v8::Number>()->Value());
+  }
+  if (value->IsUndefined()) {
+    return undefined_value;
+  }
+  return static_cast<T>(
+      value->NumberValue(Nan::GetCurrentContext()).FromMaybe(0.0));
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, T>::type
+ToNumber(v8::Local<v8::Value> value, T undefined_value) {
+  if (value->IsNumber()) {
+    return static_cast<T>(value.As<v8::Number>()->Value());
+  }
+  if (value->IsUndefined()) {
+    return undefined_value;
+  }
+  return static_cast<T>(
+      value->NumberValue(Nan::GetCurrentContext()).FromMaybe(0.0));
+}
+
+// a number as the first argument, kDefault when missing or undefined
+template <typename T, int kDefault = 0>
+struct Number {
+  using value_type = T;
+
+  static T Decode(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+    return ToNumber<T>(info[0], static_cast<T>(kDefault));
+  }
+};
+
+// a duration in nanoseconds, as (seconds, nanos) or a process.hrtime()
+// array. Either number defaults to 0. With kBothNumbers, a call that is
+// neither exactly two numbers nor an hrtime array throws
+template <bool kBothNumbers = false>
+struct Duration {
+  using value_type = int64_t;
+
+  static int64_t Decode(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+    auto argc = info.Length();
+    if (argc == 2 || (!kBothNumbers && argc != 1)) {
+      return Nanos(ToNumber<int64_t>(info[0], 0),
+                   ToNumber<int64_t>(info[1], 0));
+    }
+    if (argc == 1 && info[0]->IsArray()) {
+      return FromHrtime(info[0].As<v8::Array>());
+    }
+    if (!kBothNumbers) {
+      return Nanos(ToNumber<int64_t>(info[0], 0), 0);
+    }
+    Nan::ThrowError("Expecting two numbers: seconds and nanoseconds");
+    return 0;
+  }
+
+ private:
+  static int64_t FromHrtime(v8::Local<v8::Array> hrtime) {
+    if (hrtime->Length() != 2) {
+      Nan::ThrowError(
+          "Expecting an array of two elements: seconds, nanos. See "
+          "process.hrtime()");
+      return 0;
+    }
+    auto context = Nan::GetCurrentContext();
+    v8::Local<v8::Value> seconds, nanos;
+    if (!hrtime->Get(context, 0).ToLocal(&seconds) ||
+        !hrtime->Get(context, 1).ToLocal(&nanos)) {
+      return 0;
+    }
+    return Nanos(ToNumber<int64_t>(seconds, 0), ToNumber<int64_t>(nanos, 0));
+  }
+};
+
+}  // namespace args
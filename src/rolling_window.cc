@@ -0,0 +1,301 @@
+#include "rolling_window.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// log-linear histogram: kSubBuckets per power of 2, from 2^-31 up to 2^22.
+// Timers record seconds, so that is about 1ns to 48 days, in buckets at
+// most 12.5% wide. Index 0 holds the values below the range
+static constexpr int kSubBuckets = 8;
+static constexpr int kMinExp = -30;
+static constexpr int kMaxExp = 22;
+static constexpr size_t kHistogramSize =
+    1 + (kMaxExp - kMinExp + 1) * kSubBuckets;
+
+static size_t histogram_index(double value) {
+  if (!(value > 0)) {
+    return 0;
+  }
+  int exp;
+  auto mantissa = std::frexp(value, &exp);  // [0.5, 1)
+  if (exp < kMinExp) {
+    return 0;
+  }
+  if (exp > kMaxExp) {
+    return kHistogramSize - 1;
+  }
+  auto sub = static_cast<int>((mantissa - 0.5) * 2 * kSubBuckets);
+  return 1 + static_cast<size_t>((exp - kMinExp) * kSubBuckets + sub);
+}
+
+static double histogram_lower(size_t index) {
+  if (index == 0) {
+    return 0;
+  }
+  auto i = static_cast<int>(index - 1);
+  auto sub = i % kSubBuckets;
+  return std::ldexp(0.5 + sub / (2.0 * kSubBuckets), kMinExp + i / kSubBuckets);
+}
+
+static double histogram_upper(size_t index) {
+  if (index == 0) {
+    return std::ldexp(0.5, kMinExp);
+  }
+  auto i = static_cast<int>(index - 1);
+  auto sub = i % kSubBuckets;
+  return std::ldexp(0.5 + (sub + 1) / (2.0 * kSubBuckets),
+                    kMinExp + i / kSubBuckets);
+}
+
+static constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+RollingWindow::RollingWindow(Kind kind, int64_t window_ms, size_t buckets,
+                             int64_t now_ms)
+    : kind_{kind},
+      step_ms_{std::max<int64_t>(window_ms / std::max<size_t>(buckets, 1), 1)},
+      created_ms_{now_ms},
+      current_step_{now_ms / step_ms_},
+      buckets_(std::max<size_t>(buckets, 1)) {
+  if (kind_ == Kind::kTimer) {
+    for (auto& b : buckets_) {
+      b.histogram.resize(kHistogramSize);
+    }
+    total_histogram_.resize(kHistogramSize);
+  }
+  buckets_[current_step_ % buckets_.size()].step = current_step_;
+}
+
+void RollingWindow::Expire(Bucket* bucket) noexcept {
+  if (bucket->count > 0) {
+    total_count_ -= bucket->count;
+    total_sum_ = total_count_ > 0 ? total_sum_ - bucket->sum : 0;
+    for (size_t i = 0; i < bucket->histogram.size(); ++i) {
+      total_histogram_[i] -= bucket->histogram[i];
+    }
+    std::fill(bucket->histogram.begin(), bucket->histogram.end(), 0);
+    bucket->count = 0;
+    bucket->sum = 0;
+  }
+  bucket->step = -1;
+}
+
+void RollingWindow::Advance(int64_t now_ms) noexcept {
+  auto step = now_ms / step_ms_;
+  if (step <= current_step_) {
+    return;
+  }
+  auto n = static_cast<int64_t>(buckets_.size());
+  // at most one pass over the ring, however long it has been idle
+  for (auto s = std::max(current_step_ + 1, step - n + 1); s <= step; ++s) {
+    auto& bucket = buckets_[s % n];
+    Expire(&bucket);
+    bucket.step = s;
+  }
+  current_step_ = step;
+}
+
+void RollingWindow::Record(double value, int64_t now_ms) noexcept {
+  Advance(now_ms);
+  auto& bucket = buckets_[current_step_ % buckets_.size()];
+  bucket.count++;
+  bucket.sum += value;
+  total_count_++;
+  total_sum_ += value;
+  if (kind_ == Kind::kTimer) {
+    auto index = histogram_index(value);
+    bucket.histogram[index]++;
+    total_histogram_[index]++;
+  }
+}
+
+size_t RollingWindow::Covering(int64_t window_ms) const noexcept {
+  auto n = (window_ms + step_ms_ - 1) / step_ms_;
+  return static_cast<size_t>(
+      std::min<int64_t>(std::max<int64_t>(n, 1), buckets_.size()));
+}
+
+template <typename F>
+void RollingWindow::ForEachRecent(size_t n, F f) const {
+  auto size = static_cast<int64_t>(buckets_.size());
+  for (size_t i = 0; i < n; ++i) {
+    auto step = current_step_ - static_cast<int64_t>(i);
+    if (step < 0) {
+      break;
+    }
+    const auto& bucket = buckets_[step % size];
+    if (bucket.step == step && bucket.count > 0) {
+      f(bucket);
+    }
+  }
+}
+
+int64_t RollingWindow::Count(int64_t window_ms, int64_t now_ms) noexcept {
+  Advance(now_ms);
+  auto n = Covering(window_ms);
+  if (n == buckets_.size()) {
+    return total_count_;
+  }
+  int64_t count = 0;
+  ForEachRecent(n, [&count](const Bucket& b) { count += b.count; });
+  return count;
+}
+
+double RollingWindow::Rate(int64_t window_ms, int64_t now_ms) noexcept {
+  Advance(now_ms);
+  auto n = Covering(window_ms);
+  int64_t count = total_count_;
+  double sum = total_sum_;
+  if (n < buckets_.size()) {
+    count = 0;
+    sum = 0;
+    ForEachRecent(n, [&](const Bucket& b) {
+      count += b.count;
+      sum += b.sum;
+    });
+  }
+
+  // the current bucket is partially filled, and the window may be younger
+  // than the span asked for
+  auto span_ms = static_cast<int64_t>(n - 1) * step_ms_ +
+                 (now_ms - current_step_ * step_ms_);
+  span_ms = std::max<int64_t>(std::min(span_ms, now_ms - created_ms_), 1);
+  auto amount = kind_ == Kind::kTimer ? static_cast<double>(count) : sum;
+  return amount * 1000.0 / span_ms;
+}
+
+double RollingWindow::Mean(int64_t window_ms, int64_t now_ms) noexcept {
+  Advance(now_ms);
+  auto n = Covering(window_ms);
+  int64_t count = total_count_;
+  double sum = total_sum_;
+  if (n < buckets_.size()) {
+    count = 0;
+    sum = 0;
+    ForEachRecent(n, [&](const Bucket& b) {
+      count += b.count;
+      sum += b.sum;
+    });
+  }
+  return count > 0 ? sum / count : kNaN;
+}
+
+double RollingWindow::Percentile(double p, int64_t window_ms,
+                                 int64_t now_ms) noexcept {
+  if (kind_ != Kind::kTimer) {
+    return kNaN;
+  }
+  Advance(now_ms);
+  auto n = Covering(window_ms);
+  const std::vector<uint32_t>* histogram = &total_histogram_;
+  int64_t count = total_count_;
+  std::vector<uint32_t> merged;
+  if (n < buckets_.size()) {
+    merged.resize(kHistogramSize);
+    count = 0;
+    ForEachRecent(n, [&](const Bucket& b) {
+      count += b.count;
+      for (size_t i = 0; i < kHistogramSize; ++i) {
+        merged[i] += b.histogram[i];
+      }
+    });
+    histogram = &merged;
+  }
+  if (count == 0) {
+    return kNaN;
+  }
+
+  auto target = std::min(std::max(p, 0.0), 100.0) / 100.0 * count;
+  double seen = 0;
+  for (size_t i = 0; i < kHistogramSize; ++i) {
+    auto c = (*histogram)[i];
+    if (c == 0) {
+      continue;
+    }
+    if (seen + c >= target) {
+      // interpolate within the bucket
+      auto fraction = (target - seen) / c;
+      auto lower = histogram_lower(i);
+      return lower + (histogram_upper(i) - lower) * fraction;
+    }
+    seen += c;
+  }
+  return histogram_upper(kHistogramSize - 1);
+}
+
+Nan::Persistent<v8::Function> JsRollingWindow::constructor;
+
+NAN_MODULE_INIT(JsRollingWindow::Init) {
+  auto tpl = Nan::New<v8::FunctionTemplate>(New);
+  tpl->SetClassName(Nan::New("JsRollingWindow").ToLocalChecked());
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  Nan::SetPrototypeMethod(tpl, "rate", Rate);
+  Nan::SetPrototypeMethod(tpl, "mean", Mean);
+  Nan::SetPrototypeMethod(tpl, "percentile", Percentile);
+  Nan::SetPrototypeMethod(tpl, "count", Count);
+
+  auto context = Nan::GetCurrentContext();
+  constructor.Reset(tpl->GetFunction(context).ToLocalChecked());
+}
+
+NAN_METHOD(JsRollingWindow::New) {
+  if (info.IsConstructCall()) {
+    auto obj = new JsRollingWindow();
+    obj->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  } else {
+    Nan::ThrowError("not implemented");
+  }
+}
+
+v8::Local<v8::Object> JsRollingWindow::NewInstance(
+    std::shared_ptr<RollingWindow> window) {
+  Nan::EscapableHandleScope scope;
+  auto cons = Nan::New<v8::Function>(constructor);
+  auto instance = Nan::NewInstance(cons, 0, nullptr).ToLocalChecked();
+  Nan::ObjectWrap::Unwrap<JsRollingWindow>(instance)->window_ =
+      std::move(window);
+  return scope.Escape(instance);
+}
+
+// the optional windowMs argument at index i, the whole window by default
+static int64_t window_arg(const Nan::FunctionCallbackInfo<v8::Value>& info,
+                          int i, const RollingWindow& window) {
+  if (info.Length() > i && info[i]->IsNumber()) {
+    auto ms = Nan::To<double>(info[i]).FromJust();
+    if (ms >= 1) {
+      return static_cast<int64_t>(ms);
+    }
+  }
+  return window.WindowMs();
+}
+
+NAN_METHOD(JsRollingWindow::Rate) {
+  auto& w = *Nan::ObjectWrap::Unwrap<JsRollingWindow>(info.This())->window_;
+  info.GetReturnValue().Set(
+      w.Rate(window_arg(info, 0, w), rolling_window_now()));
+}
+
+NAN_METHOD(JsRollingWindow::Mean) {
+  auto& w = *Nan::ObjectWrap::Unwrap<JsRollingWindow>(info.This())->window_;
+  info.GetReturnValue().Set(
+      w.Mean(window_arg(info, 0, w), rolling_window_now()));
+}
+
+NAN_METHOD(JsRollingWindow::Percentile) {
+  auto& w = *Nan::ObjectWrap::Unwrap<JsRollingWindow>(info.This())->window_;
+  if (info.Length() == 0 || !info[0]->IsNumber()) {
+    Nan::ThrowError(
+        "Need the percentile to compute as a number from 0.0 to 100.0");
+    return;
+  }
+  auto p = Nan::To<double>(info[0]).FromJust();
+  info.GetReturnValue().Set(
+      w.Percentile(p, window_arg(info, 1, w), rolling_window_now()));
+}
+
+NAN_METHOD(JsRollingWindow::Count) {
+  auto& w = *Nan::ObjectWrap::Unwrap<JsRollingWindow>(info.This())->window_;
+  info.GetReturnValue().Set(static_cast<double>(
+      w.Count(window_arg(info, 0, w), rolling_window_now())));
+}
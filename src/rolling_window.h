@@ -0,0 +1,86 @@
+#pragma once
+
+#include <nan.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// recent activity of one meter, for decisions made inside the process. A
+// ring of buckets, each covering window / buckets ms, with running totals
+// over the whole ring. Queries over the whole window only read the totals,
+// shorter windows add up the buckets they cover. Not thread safe
+class RollingWindow {
+ public:
+  // counters report the rate of the amounts recorded, timers the rate of
+  // the records and keep a histogram of the values for percentiles
+  enum class Kind { kCounter, kTimer };
+
+  RollingWindow(Kind kind, int64_t window_ms, size_t buckets, int64_t now_ms);
+
+  void Record(double value, int64_t now_ms) noexcept;
+
+  // records per second for timers, amount per second for counters
+  double Rate(int64_t window_ms, int64_t now_ms) noexcept;
+  // mean of the values recorded, NaN if there were none
+  double Mean(int64_t window_ms, int64_t now_ms) noexcept;
+  // estimated from the histogram, NaN for counters or if there were no
+  // records
+  double Percentile(double p, int64_t window_ms, int64_t now_ms) noexcept;
+  // number of records
+  int64_t Count(int64_t window_ms, int64_t now_ms) noexcept;
+
+  int64_t WindowMs() const noexcept {
+    return step_ms_ * static_cast<int64_t>(buckets_.size());
+  }
+
+ private:
+  struct Bucket {
+    // step this bucket covers, -1 if unused
+    int64_t step = -1;
+    int64_t count = 0;
+    double sum = 0;
+    std::vector<uint32_t> histogram;
+  };
+
+  void Advance(int64_t now_ms) noexcept;
+  void Expire(Bucket* bucket) noexcept;
+  // number of buckets, including the current one, covering window_ms
+  size_t Covering(int64_t window_ms) const noexcept;
+  // call f on each of the last n buckets that has data
+  template <typename F>
+  void ForEachRecent(size_t n, F f) const;
+
+  Kind kind_;
+  int64_t step_ms_;
+  int64_t created_ms_;
+  int64_t current_step_;
+  std::vector<Bucket> buckets_;
+  int64_t total_count_ = 0;
+  double total_sum_ = 0;
+  std::vector<uint32_t> total_histogram_;
+};
+
+// JS view of a meter's rolling window: rate([windowMs]), mean([windowMs]),
+// percentile(p, [windowMs]), count([windowMs])
+class JsRollingWindow : public Nan::ObjectWrap {
+ public:
+  static NAN_MODULE_INIT(Init);
+
+  static v8::Local<v8::Object> NewInstance(
+      std::shared_ptr<RollingWindow> window);
+
+ private:
+  static NAN_METHOD(New);
+  static NAN_METHOD(Rate);
+  static NAN_METHOD(Mean);
+  static NAN_METHOD(Percentile);
+  static NAN_METHOD(Count);
+
+  static Nan::Persistent<v8::Function> constructor;
+  std::shared_ptr<RollingWindow> window_;
+};
+
+// current time for rolling windows
+inline int64_t rolling_window_now() noexcept {
+  return static_cast<int64_t>(uv_hrtime() / 1000000);
+}
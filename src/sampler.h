@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// larger factors are rejected: one sample would stand for too many events
+constexpr uint32_t kMaxSamplingFactor = 10000;
+
+// decides which 1 in N events to keep. The countdown to the next sample is
+// jittered around the sampling factor, so periodic patterns in the callers
+// do not bias which events are kept. Not thread safe
+class Sampler {
+ public:
+  Sampler(uint32_t factor, uint32_t seed) noexcept
+      : factor_{factor > 0 ? factor : 1},
+        countdown_{1},
+        rng_state_{seed | 1u} {}
+
+  bool Sample() noexcept {
+    if (--countdown_ > 0) {
+      return false;
+    }
+    // xorshift32
+    rng_state_ ^= rng_state_ << 13;
+    rng_state_ ^= rng_state_ >> 17;
+    rng_state_ ^= rng_state_ << 5;
+    // uniform in [1, 2 * factor - 1], so the mean gap is factor
+    countdown_ = 1 + rng_state_ % (2 * factor_ - 1);
+    return true;
+  }
+
+  uint32_t Factor() const noexcept { return factor_; }
+
+ private:
+  uint32_t factor_;
+  uint32_t countdown_;
+  uint32_t rng_state_;
+};
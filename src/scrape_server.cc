@@ -0,0 +1,407 @@
+#include "scrape_server.h"
+#include "atlas.h"
+#include "lazy_gauges.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+using atlas::meter::Measurement;
+using atlas::meter::Tags;
+
+// joined by stop_scrape_server(), which also runs as an environment cleanup
+// hook so the thread is gone before the registry is torn down
+static std::thread* scrape_thread = nullptr;
+static bool cleanup_hook_added = false;
+static std::atomic<bool> scrape_running{false};
+static int listen_fd = -1;
+static std::string listen_path;
+
+static constexpr int kPollTimeoutMs = 250;
+static constexpr size_t kMaxRequestSize = 8192;
+
+static void append_number(std::ostream& os, double value) {
+  if (std::isnan(value)) {
+    os << "NaN";
+    return;
+  }
+  char buf[32];
+  // shortest representation that round-trips
+  for (auto precision = 15; precision <= 17; ++precision) {
+    snprintf(buf, sizeof buf, "%.*g", precision, value);
+    if (strtod(buf, nullptr) == value) {
+      break;
+    }
+  }
+  os << buf;
+}
+
+static void append_json_str(std::ostream& os, const char* s) {
+  os << '"';
+  for (; *s != '\0'; ++s) {
+    auto c = static_cast<unsigned char>(*s);
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\r':
+        os << "\\r";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (c < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof buf, "\\u%04x", c);
+          os << buf;
+        } else {
+          os << *s;
+        }
+    }
+  }
+  os << '"';
+}
+
+// metric and label names in the text exposition format are restricted to
+// [a-zA-Z0-9_:], atlas names commonly use '.'
+static void append_text_name(std::ostream& os, const char* s) {
+  if (*s >= '0' && *s <= '9') {
+    os << '_';
+  }
+  for (; *s != '\0'; ++s) {
+    auto c = *s;
+    auto valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                 (c >= '0' && c <= '9') || c == '_' || c == ':';
+    os << (valid ? c : '_');
+  }
+}
+
+static void append_text_value(std::ostream& os, const char* s) {
+  os << '"';
+  for (; *s != '\0'; ++s) {
+    switch (*s) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      default:
+        os << *s;
+    }
+  }
+  os << '"';
+}
+
+static void write_json(std::ostream& os, const Tags& common_tags,
+                       const atlas::meter::Measurements& measurements) {
+  os << '[';
+  auto first = true;
+  for (const auto& m : measurements) {
+    if (!first) {
+      os << ',';
+    }
+    first = false;
+    os << "{\"tags\":{\"name\":";
+    append_json_str(os, m.id->Name());
+    for (const auto& kv : common_tags) {
+      os << ',';
+      append_json_str(os, kv.first.get());
+      os << ':';
+      append_json_str(os, kv.second.get());
+    }
+    for (const auto& kv : m.id->GetTags()) {
+      os << ',';
+      append_json_str(os, kv.first.get());
+      os << ':';
+      append_json_str(os, kv.second.get());
+    }
+    os << "},\"value\":";
+    if (std::isnan(m.value)) {
+      os << "null";
+    } else {
+      append_number(os, m.value);
+    }
+    os << '}';
+  }
+  os << "]\n";
+}
+
+static void append_text_tags(std::ostream& os, const Tags& tags, bool* first) {
+  for (const auto& kv : tags) {
+    if (!*first) {
+      os << ',';
+    }
+    *first = false;
+    append_text_name(os, kv.first.get());
+    os << '=';
+    append_text_value(os, kv.second.get());
+  }
+}
+
+static void write_text(std::ostream& os, const Tags& common_tags,
+                       const atlas::meter::Measurements& measurements) {
+  for (const auto& m : measurements) {
+    append_text_name(os, m.id->Name());
+    os << '{';
+    auto first = true;
+    append_text_tags(os, common_tags, &first);
+    append_text_tags(os, m.id->GetTags(), &first);
+    os << "} ";
+    append_number(os, m.value);
+    os << '\n';
+  }
+}
+
+static void send_all(int fd, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    auto n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return;
+    }
+    sent += static_cast<size_t>(n);
+  }
+}
+
+static void send_response(int fd, const char* status, const char* content_type,
+                          const std::string& body) {
+  std::ostringstream os;
+  os << "HTTP/1.1 " << status << "\r\n"
+     << "Content-Type: " << content_type << "\r\n"
+     << "Content-Length: " << body.size() << "\r\n"
+     << "Connection: close\r\n\r\n"
+     << body;
+  send_all(fd, os.str());
+}
+
+static void handle_client(int fd) {
+  struct timeval tv {};
+  tv.tv_sec = 1;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+
+  std::string request;
+  char buf[1024];
+  while (request.find("\r\n\r\n") == std::string::npos &&
+         request.size() < kMaxRequestSize) {
+    auto n = recv(fd, buf, sizeof buf, 0);
+    if (n <= 0) {
+      break;
+    }
+    request.append(buf, static_cast<size_t>(n));
+  }
+
+  // GET <path> HTTP/1.x
+  auto line_end = request.find("\r\n");
+  std::istringstream line{request.substr(0, line_end)};
+  std::string method, path;
+  line >> method >> path;
+  if (method != "GET") {
+    send_response(fd, "405 Method Not Allowed", "text/plain", "GET only\n");
+    return;
+  }
+
+  auto json = path == "/metrics.json" ||
+              path.find("format=json") != std::string::npos;
+  auto text = path == "/metrics" || path.compare(0, 9, "/metrics?") == 0;
+  if (!json && !text) {
+    send_response(fd, "404 Not Found", "text/plain",
+                  "try /metrics or /metrics.json\n");
+    return;
+  }
+
+  // only gauges that can be computed without V8 are refreshed here
+  refresh_lazy_gauges(false);
+  const auto& common_tags = atlas_client().GetConfig()->CommonTags();
+  const auto& measurements = atlas_registry()->measurements();
+  std::ostringstream body;
+  if (json) {
+    write_json(body, common_tags, measurements);
+    send_response(fd, "200 OK", "application/json", body.str());
+  } else {
+    write_text(body, common_tags, measurements);
+    send_response(fd, "200 OK", "text/plain; version=0.0.4", body.str());
+  }
+}
+
+static void serve() {
+  struct pollfd pfd {};
+  pfd.fd = listen_fd;
+  pfd.events = POLLIN;
+  while (scrape_running) {
+    auto ready = poll(&pfd, 1, kPollTimeoutMs);
+    if (ready <= 0) {
+      continue;
+    }
+    auto client = accept(listen_fd, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+    handle_client(client);
+    close(client);
+  }
+}
+
+static int listen_unix(const std::string& path, std::string* err_msg) {
+  struct sockaddr_un addr {};
+  if (path.size() >= sizeof addr.sun_path) {
+    *err_msg = "unix socket path is too long: " + path;
+    return -1;
+  }
+  // a socket left behind by a previous run is replaced, anything else at
+  // that path is not ours to remove
+  struct stat st;
+  if (lstat(path.c_str(), &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      *err_msg = "unable to listen on " + path + ": not a socket";
+      return -1;
+    }
+    unlink(path.c_str());
+  }
+  auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    *err_msg = strerror(errno);
+    return -1;
+  }
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof addr.sun_path - 1);
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) < 0 ||
+      listen(fd, 16) < 0) {
+    *err_msg = "unable to listen on " + path + ": " + strerror(errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int listen_loopback(int port, int* bound_port, std::string* err_msg) {
+  auto fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    *err_msg = strerror(errno);
+    return -1;
+  }
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+
+  struct sockaddr_in addr {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) < 0 ||
+      listen(fd, 16) < 0) {
+    *err_msg =
+        "unable to listen on 127.0.0.1:" + std::to_string(port) + ": " +
+        strerror(errno);
+    close(fd);
+    return -1;
+  }
+
+  socklen_t len = sizeof addr;
+  getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+  *bound_port = ntohs(addr.sin_port);
+  return fd;
+}
+
+int start_scrape_server(const ScrapeOptions& options, std::string* err_msg) {
+  if (scrape_running) {
+    *err_msg = "scrape server is already running";
+    return -1;
+  }
+
+  // make sure the client exists before another thread can reach it
+  atlas_registry();
+
+  int bound_port = 0;
+  if (options.socket_path.empty()) {
+    listen_fd = listen_loopback(options.port, &bound_port, err_msg);
+  } else {
+    listen_fd = listen_unix(options.socket_path, err_msg);
+    listen_path = options.socket_path;
+  }
+  if (listen_fd < 0) {
+    listen_path.clear();
+    return -1;
+  }
+
+  scrape_running = true;
+  scrape_thread = new std::thread(serve);
+  if (!cleanup_hook_added) {
+    node::AddEnvironmentCleanupHook(
+        v8::Isolate::GetCurrent(), [](void*) { stop_scrape_server(); },
+        nullptr);
+    cleanup_hook_added = true;
+  }
+  return bound_port;
+}
+
+void stop_scrape_server() {
+  if (!scrape_running) {
+    return;
+  }
+  scrape_running = false;
+  scrape_thread->join();
+  delete scrape_thread;
+  scrape_thread = nullptr;
+  close(listen_fd);
+  listen_fd = -1;
+  if (!listen_path.empty()) {
+    unlink(listen_path.c_str());
+    listen_path.clear();
+  }
+}
+
+bool scrape_options_from_object(v8::Isolate* isolate,
+                                const v8::Local<v8::Object>& object,
+                                ScrapeOptions* options) {
+  auto context = isolate->GetCurrentContext();
+  auto port = object->Get(context, Nan::New("port").ToLocalChecked());
+  if (!port.IsEmpty() && port.ToLocalChecked()->IsNumber()) {
+    options->port = Nan::To<int32_t>(port.ToLocalChecked()).FromJust();
+  }
+  auto path = object->Get(context, Nan::New("path").ToLocalChecked());
+  if (!path.IsEmpty() && path.ToLocalChecked()->IsString()) {
+    options->socket_path = *Nan::Utf8String(path.ToLocalChecked());
+  }
+  return options->port >= 0 && options->port <= 65535;
+}
+
+NAN_METHOD(start_scrape) {
+  ScrapeOptions options;
+  if (info.Length() > 0 && info[0]->IsObject()) {
+    if (!scrape_options_from_object(info.GetIsolate(),
+                                    info[0].As<v8::Object>(), &options)) {
+      Nan::ThrowRangeError("Invalid port for the scrape server");
+      return;
+    }
+  }
+
+  std::string err_msg;
+  auto port = start_scrape_server(options, &err_msg);
+  if (port < 0) {
+    Nan::ThrowError(err_msg.c_str());
+    return;
+  }
+  info.GetReturnValue().Set(port);
+}
+
+NAN_METHOD(stop_scrape) { stop_scrape_server(); }
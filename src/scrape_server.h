@@ -0,0 +1,32 @@
+#pragma once
+
+#include <nan.h>
+#include <string>
+
+// serves snapshots of the registry to local scrapers from a native thread
+// so a scrape never touches V8 or the event loop
+struct ScrapeOptions {
+  // loopback port to listen on. 0 picks an ephemeral port
+  int port = 0;
+  // when non-empty, listen on this unix socket instead of a tcp port
+  std::string socket_path;
+};
+
+// start the listener. Returns the port bound (0 for unix sockets), or -1
+// setting err_msg if the listener could not be started
+int start_scrape_server(const ScrapeOptions& options, std::string* err_msg);
+
+// stop the listener (if running) and wait for its thread to finish
+void stop_scrape_server();
+
+// parse a {port, path} object into options
+bool scrape_options_from_object(v8::Isolate* isolate,
+                                const v8::Local<v8::Object>& object,
+                                ScrapeOptions* options);
+
+// start the scrape listener: startScrapeServer({port: 0}) or
+// startScrapeServer({path: '/tmp/atlas.sock'})
+NAN_METHOD(start_scrape);
+
+// stop the scrape listener
+NAN_METHOD(stop_scrape);
@@ -0,0 +1,115 @@
+#include "self_metrics.h"
+#include "atlas.h"
+#include "sampler.h"
+#include "start_stop.h"
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+using atlas::meter::Counter;
+using atlas::meter::Tag;
+using atlas::meter::Timer;
+
+static bool enabled = false;
+static Sampler sampler{1, 0x9e3779b9u};
+
+static std::shared_ptr<Counter> ids_created;
+static std::shared_ptr<Counter> tag_bytes;
+static std::shared_ptr<Timer> call_timers[static_cast<int>(SelfOp::kNumOps)];
+// keyed by the string literal passed by the wrappers
+static std::unordered_map<const char*, std::shared_ptr<Counter>> wrappers;
+
+static const char* op_name(SelfOp op) {
+  switch (op) {
+    case SelfOp::kMeasurements:
+      return "measurements";
+    case SelfOp::kPush:
+      return "push";
+    case SelfOp::kConfig:
+      return "config";
+    case SelfOp::kBeforeGC:
+      return "beforeGC";
+    case SelfOp::kAfterGC:
+      return "afterGC";
+    case SelfOp::kSampler:
+      return "sampler";
+    default:
+      return "unknown";
+  }
+}
+
+void set_self_metrics(uint32_t sample_rate) {
+  enabled = sample_rate > 0;
+  if (!enabled) {
+    return;
+  }
+
+  sample_rate = std::min(sample_rate, kMaxSamplingFactor);
+  sampler = Sampler{sample_rate, 0x9e3779b9u};
+  auto r = atlas_registry();
+  ids_created = r->counter(node_id("atlas.client.idsCreated"));
+  tag_bytes = r->counter(node_id("atlas.client.tagBytes"));
+
+  std::ostringstream rate;
+  rate << 1.0 / sample_rate;
+  auto time_id = node_id("atlas.client.callTime")
+                     ->WithTag(Tag::of("sampleRate", rate.str()));
+  for (auto i = 0; i < static_cast<int>(SelfOp::kNumOps); ++i) {
+    auto op = op_name(static_cast<SelfOp>(i));
+    call_timers[i] = r->timer(time_id->WithTag(Tag::of("op", op)));
+  }
+  wrappers.clear();
+}
+
+void self_count_id() {
+  if (enabled) {
+    ids_created->Increment();
+  }
+}
+
+void self_count_wrapper(const char* type) {
+  if (!enabled) {
+    return;
+  }
+  auto it = wrappers.find(type);
+  if (it == wrappers.end()) {
+    auto id = node_id("atlas.client.wrappersCreated")
+                  ->WithTag(Tag::of("type", type));
+    it = wrappers.emplace(type, atlas_registry()->counter(id)).first;
+  }
+  it->second->Increment();
+}
+
+void self_count_tag_bytes(size_t bytes) {
+  if (enabled) {
+    tag_bytes->Add(static_cast<int64_t>(bytes));
+  }
+}
+
+SelfTimer::SelfTimer(SelfOp op) noexcept : op_{op}, start_{0} {
+  if (enabled && sampler.Sample()) {
+    start_ = atlas_registry()->clock().MonotonicTime();
+  }
+}
+
+// one record per sample, the sampleRate tag tells how to scale them
+SelfTimer::~SelfTimer() {
+  if (start_ == 0 || !enabled) {
+    return;
+  }
+  auto elapsed = atlas_registry()->clock().MonotonicTime() - start_;
+  call_timers[static_cast<int>(op_)]->Record(elapsed);
+}
+
+NAN_METHOD(set_self_metrics) {
+  uint32_t rate = 1;
+  if (info.Length() > 0) {
+    if (info[0]->IsBoolean()) {
+      rate = Nan::To<bool>(info[0]).FromJust() ? 1 : 0;
+    } else if (info[0]->IsNumber()) {
+      auto n = Nan::To<double>(info[0]).FromJust();
+      rate = n > 0 ? static_cast<uint32_t>(n) : 0;
+    }
+  }
+  set_self_metrics(rate);
+}
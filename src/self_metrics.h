@@ -0,0 +1,42 @@
+#pragma once
+
+#include <nan.h>
+#include <cstddef>
+#include <cstdint>
+
+// optional accounting of what the binding itself costs, published as
+// atlas.client.* meters. Everything here is a single branch when disabled.
+// Only call these from the JS thread
+
+enum class SelfOp {
+  kMeasurements,
+  kPush,
+  kConfig,
+  kBeforeGC,
+  kAfterGC,
+  kSampler,
+  kNumOps
+};
+
+// 0 disables self metrics, 1 times every call, N times 1 in N calls and
+// records only those, tagged with sampleRate 1/N. N is capped at
+// kMaxSamplingFactor. Counters are always exact while enabled
+void set_self_metrics(uint32_t sample_rate);
+
+void self_count_id();
+void self_count_wrapper(const char* type);
+void self_count_tag_bytes(size_t bytes);
+
+// times the enclosing scope into atlas.client.callTime
+class SelfTimer {
+ public:
+  explicit SelfTimer(SelfOp op) noexcept;
+  ~SelfTimer();
+
+ private:
+  SelfOp op_;
+  int64_t start_;
+};
+
+// setSelfMetrics(n)
+NAN_METHOD(set_self_metrics);
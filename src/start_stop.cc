@@ -1,12 +1,22 @@
 #include "start_stop.h"
 #include "atlas.h"
+#include "cgroup.h"
+#include "cpu_profile.h"
+#include "js_meter.h"
+#include "scrape_server.h"
+#include "self_metrics.h"
 #include "utils.h"
+#include "watchdog.h"
+#include <atlas/meter/percentile_timer.h>
+#include <atomic>
+#include <thread>
 #include <unordered_map>
 #include <sys/resource.h>
 
 using atlas::meter::Counter;
 using atlas::meter::Gauge;
 using atlas::meter::IdPtr;
+using atlas::meter::PercentileTimer;
 using atlas::meter::Registry;
 using atlas::meter::Tag;
 using atlas::meter::Tags;
@@ -15,12 +25,25 @@ using v8::GCType;
 using v8::HeapSpaceStatistics;
 
 static bool started = false;
+// startAsync() is loading the config and starting the publisher
+static bool starting = false;
+// stop() was called while starting
+static bool stop_requested = false;
+// stopAsync() is flushing on a background thread
+static bool stopping = false;
+struct StopRequest;
+// stopAsync() was called while starting, its flush starts once the client is
+// up
+static StopRequest* pending_stop = nullptr;
+static void flush_in_background(StopRequest* req);
 static bool timer_started = false;
 static uv_timer_t lag_timer;
 static uv_timer_t fd_timer;
+static uv_timer_t threadpool_timer;
 static int64_t prev_timestamp;
 static constexpr unsigned int POLL_PERIOD_MS = 500;
 static constexpr unsigned int FD_PERIOD_MS = 30 * 1000;
+static constexpr unsigned int THREADPOOL_PERIOD_MS = 1000;
 static constexpr int64_t POLL_PERIOD_NS = POLL_PERIOD_MS * 1000000;
 static Tags runtime_tags;
 
@@ -28,6 +51,16 @@ static Tags runtime_tags;
 static std::shared_ptr<Timer> atlas_lag_timer;
 static std::shared_ptr<Gauge<double>> open_fd_gauge;
 static std::shared_ptr<Gauge<double>> max_fd_gauge;
+static std::shared_ptr<PercentileTimer> threadpool_wait_timer;
+static std::shared_ptr<Gauge<double>> active_reqs_gauge;
+static std::unordered_map<int, std::shared_ptr<Gauge<double>>> handle_gauges;
+
+// a no-op work request, timed from queueing until a pool thread picks it up.
+// Only one is in flight, so a saturated pool gets no extra work from us
+static uv_work_t probe_req;
+static bool probe_in_flight = false;
+static uint64_t probe_queued;
+static std::atomic<uint64_t> probe_started{0};
 
 static void record_lag(uv_timer_t* handle) {
   auto now = atlas_registry()->clock().MonotonicTime();
@@ -61,13 +94,66 @@ static size_t get_dir_count(const char* dir) {
   return count;
 }
 
+static void count_handle(uv_handle_t* handle, void* arg) {
+  if (uv_is_active(handle)) {
+    auto counts = static_cast<std::unordered_map<int, size_t>*>(arg);
+    ++(*counts)[handle->type];
+  }
+}
+
+// active handles by type, and the number of active requests
+static void record_active_handles() {
+  std::unordered_map<int, size_t> counts;
+  uv_walk(uv_default_loop(), count_handle, &counts);
+
+  // types seen before but gone now go back to 0
+  for (auto& kv : handle_gauges) {
+    if (counts.find(kv.first) == counts.end()) {
+      kv.second->Update(0);
+    }
+  }
+  for (const auto& kv : counts) {
+    auto& gauge = handle_gauges[kv.first];
+    if (!gauge) {
+      auto type = static_cast<uv_handle_type>(kv.first);
+      auto id = node_id("nodejs.activeHandles")
+                    ->WithTag(Tag::of("id", uv_handle_type_name(type)));
+      gauge = atlas_registry()->gauge(id);
+    }
+    gauge->Update(kv.second);
+  }
+  active_reqs_gauge->Update(uv_default_loop()->active_reqs.count);
+}
+
 static void record_fd_activity(uv_timer_t* handle) {
+  SelfTimer self_timer{SelfOp::kSampler};
   auto fd_count = get_dir_count("/proc/self/fd");
   struct rlimit rl;
   getrlimit(RLIMIT_NOFILE, &rl);
 
   open_fd_gauge->Update(fd_count);
   max_fd_gauge->Update(rl.rlim_cur);
+  record_active_handles();
+}
+
+static void probe_work(uv_work_t*) { probe_started = uv_hrtime(); }
+
+static void after_probe_work(uv_work_t*, int status) {
+  probe_in_flight = false;
+  if (status == 0 && timer_started) {
+    threadpool_wait_timer->Record(
+        std::chrono::nanoseconds(probe_started - probe_queued));
+  }
+}
+
+static void probe_threadpool(uv_timer_t* handle) {
+  if (probe_in_flight) {
+    // still queued: its wait will be recorded once it runs
+    return;
+  }
+  probe_in_flight = true;
+  probe_queued = uv_hrtime();
+  uv_queue_work(uv_default_loop(), &probe_req, probe_work, after_probe_work);
 }
 
 static HeapSpaceStatistics* beforeStats;
@@ -79,7 +165,7 @@ static std::shared_ptr<Gauge<double>> max_data_size;
 
 static std::unordered_map<int, std::shared_ptr<Timer>> gc_timers;
 
-inline IdPtr node_id(const char* name) {
+IdPtr node_id(const char* name) {
   return atlas_registry()->CreateId(name, runtime_tags);
 }
 
@@ -142,6 +228,7 @@ static bool fill_heap_stats(HeapSpaceStatistics* stats) {
 }
 
 static NAN_GC_CALLBACK(beforeGC) {
+  SelfTimer self_timer{SelfOp::kBeforeGC};
   startGC = atlas_registry()->clock().MonotonicTime();
   fill_heap_stats(beforeStats);
 }
@@ -158,6 +245,7 @@ static int find_space_idx(HeapSpaceStatistics* stats, const char* name) {
 }
 
 static NAN_GC_CALLBACK(afterGC) {
+  SelfTimer self_timer{SelfOp::kAfterGC};
   auto elapsed = atlas_registry()->clock().MonotonicTime() - startGC;
   get_gc_timer(type)->Record(elapsed);
 
@@ -203,20 +291,25 @@ static NAN_GC_CALLBACK(afterGC) {
   }
 }
 
-NAN_METHOD(start) {
-  if (started) {
-    return;
-  }
-
-  std::vector<std::string> log_dirs;
-  if (info.Length() == 1 && info[0]->IsObject()) {
-    auto isolate = info.GetIsolate();
+// everything in start() that needs the JS thread
+static void apply_start_options(v8::Isolate* isolate,
+                                v8::Local<v8::Value> value,
+                                std::vector<std::string>* log_dirs) {
+  if (value->IsObject()) {
     auto context = isolate->GetCurrentContext();
-    const auto& options = info[0].As<v8::Object>();
+    const auto& options = value.As<v8::Object>();
     const auto& logDirsKey = Nan::New("logDirs").ToLocalChecked();
     const auto& runtimeMetricsKey = Nan::New("runtimeMetrics").ToLocalChecked();
     const auto& runtimeTagsKey = Nan::New("runtimeTags").ToLocalChecked();
     const auto& devModeKey = Nan::New("developmentMode").ToLocalChecked();
+    const auto& scrapeKey = Nan::New("scrape").ToLocalChecked();
+    const auto& selfMetricsKey = Nan::New("selfMetrics").ToLocalChecked();
+    const auto& cardinalityKey =
+        Nan::New("cardinalityLimit").ToLocalChecked();
+    const auto& meterTtlKey = Nan::New("meterTtlMs").ToLocalChecked();
+    const auto& watchdogKey = Nan::New("stallWatchdog").ToLocalChecked();
+    const auto& cpuProfileKey = Nan::New("cpuProfile").ToLocalChecked();
+    const auto& cgroupRootKey = Nan::New("cgroupRoot").ToLocalChecked();
 
     auto maybeLogDirs = options->Get(context, logDirsKey);
     if (!maybeLogDirs.IsEmpty()) {
@@ -225,7 +318,7 @@ NAN_METHOD(start) {
       for (size_t i = 0; i < n; ++i) {
         auto dir = input_log_dirs->Get(context, i).ToLocalChecked();
         const auto& path = std::string(*Nan::Utf8String(dir));
-        log_dirs.push_back(path);
+        log_dirs->push_back(path);
       }
     }
 
@@ -255,6 +348,15 @@ NAN_METHOD(start) {
 
         create_memory_meters(r);
         create_gc_timers(r);
+        auto maybe_profile = options->Get(context, cpuProfileKey);
+        if (!maybe_profile.IsEmpty() &&
+            maybe_profile.ToLocalChecked()->IsObject()) {
+          CpuProfileOptions profile_options;
+          cpu_profile_options_from_object(
+              maybe_profile.ToLocalChecked().As<v8::Object>(),
+              &profile_options);
+          start_cpu_profile(profile_options);
+        }
         beforeStats = alloc_heap_stats();
 
         Nan::AddGCPrologueCallback(beforeGC);
@@ -262,6 +364,22 @@ NAN_METHOD(start) {
 
         open_fd_gauge = r->gauge(node_id("openFileDescriptorsCount"));
         max_fd_gauge = r->gauge(node_id("maxFileDescriptorsCount"));
+        active_reqs_gauge = r->gauge(node_id("nodejs.activeRequests"));
+
+        threadpool_wait_timer = std::make_shared<PercentileTimer>(
+            r, node_id("nodejs.threadpool.queueWait"));
+        uv_timer_init(uv_default_loop(), &threadpool_timer);
+        uv_unref(reinterpret_cast<uv_handle_t*>(&threadpool_timer));
+        uv_timer_start(&threadpool_timer, probe_threadpool,
+                       THREADPOOL_PERIOD_MS, THREADPOOL_PERIOD_MS);
+
+        std::string cgroup_root = kDefaultCgroupRoot;
+        auto maybe_cgroup_root = options->Get(context, cgroupRootKey);
+        if (!maybe_cgroup_root.IsEmpty() &&
+            maybe_cgroup_root.ToLocalChecked()->IsString()) {
+          cgroup_root = *Nan::Utf8String(maybe_cgroup_root.ToLocalChecked());
+        }
+        start_cgroup_sampler(cgroup_root);
       }
     }
 
@@ -269,29 +387,276 @@ NAN_METHOD(start) {
     if (!maybe_dev_mode.IsEmpty()) {
       dev_mode = maybe_dev_mode.ToLocalChecked().As<v8::Boolean>()->Value();
     }
+
+    // true, or N to time 1 in N calls
+    auto maybe_self = options->Get(context, selfMetricsKey);
+    if (!maybe_self.IsEmpty()) {
+      auto self = maybe_self.ToLocalChecked();
+      if (self->IsNumber() && Nan::To<double>(self).FromJust() >= 1) {
+        set_self_metrics(Nan::To<uint32_t>(self).FromJust());
+      } else if (self->IsTrue()) {
+        set_self_metrics(1);
+      }
+    }
+
+    auto maybe_limit = options->Get(context, cardinalityKey);
+    if (!maybe_limit.IsEmpty() && maybe_limit.ToLocalChecked()->IsNumber()) {
+      auto limit = Nan::To<double>(maybe_limit.ToLocalChecked()).FromJust();
+      set_cardinality_limit(limit > 0 ? static_cast<size_t>(limit) : 0);
+    }
+
+    auto maybe_ttl = options->Get(context, meterTtlKey);
+    if (!maybe_ttl.IsEmpty() && maybe_ttl.ToLocalChecked()->IsNumber()) {
+      auto ttl = Nan::To<double>(maybe_ttl.ToLocalChecked()).FromJust();
+      JsMeter::SetIdleTtl(ttl > 0 ? static_cast<uint64_t>(ttl) : 0);
+    }
+
+    auto maybe_watchdog = options->Get(context, watchdogKey);
+    if (!maybe_watchdog.IsEmpty() &&
+        maybe_watchdog.ToLocalChecked()->IsObject()) {
+      WatchdogOptions watchdog_options;
+      watchdog_options_from_object(
+          maybe_watchdog.ToLocalChecked().As<v8::Object>(),
+          &watchdog_options);
+      start_watchdog(watchdog_options);
+    }
+
+    auto maybe_scrape = options->Get(context, scrapeKey);
+    if (!maybe_scrape.IsEmpty() && maybe_scrape.ToLocalChecked()->IsObject()) {
+      ScrapeOptions scrape_options;
+      std::string err_msg = "invalid port";
+      if (!scrape_options_from_object(
+              isolate, maybe_scrape.ToLocalChecked().As<v8::Object>(),
+              &scrape_options) ||
+          start_scrape_server(scrape_options, &err_msg) < 0) {
+        fprintf(stderr, "Unable to start atlas scrape server: %s\n",
+                err_msg.c_str());
+      }
+    }
   }
+}
 
+// loads the config, sets up logging and starts the publisher thread. Does
+// not touch V8
+static void start_client(const std::vector<std::string>& log_dirs) {
   if (!log_dirs.empty()) {
     atlas_client().SetLoggingDirs(log_dirs);
   }
   atlas_client().Start();
+}
+
+NAN_METHOD(start) {
+  if (started || starting || stopping) {
+    return;
+  }
+
+  std::vector<std::string> log_dirs;
+  if (info.Length() == 1) {
+    apply_start_options(info.GetIsolate(), info[0], &log_dirs);
+  }
+  start_client(log_dirs);
   started = true;
 }
 
-NAN_METHOD(stop) {
-  if (started) {
-    atlas_client().Stop();
-    started = false;
+// starts the client on the libuv thread pool. The registry already exists,
+// so meters can be created and updated while this runs
+class StartWorker : public Nan::AsyncWorker {
+ public:
+  StartWorker(Nan::Callback* callback, std::vector<std::string> log_dirs)
+      : Nan::AsyncWorker{callback, "atlas:startAsync"},
+        log_dirs_{std::move(log_dirs)} {}
+
+  void Execute() override { start_client(log_dirs_); }
+
+ protected:
+  void HandleOKCallback() override {
+    starting = false;
+    started = true;
+    if (pending_stop != nullptr) {
+      auto req = pending_stop;
+      pending_stop = nullptr;
+      stop_requested = false;
+      started = false;
+      flush_in_background(req);
+    } else if (stop_requested) {
+      stop_requested = false;
+      atlas_client().Stop();
+      started = false;
+    }
+    callback->Call(0, nullptr, async_resource);
+  }
+
+ private:
+  std::vector<std::string> log_dirs_;
+};
+
+// startAsync([options], callback)
+NAN_METHOD(start_async) {
+  auto argc = info.Length();
+  if (argc == 0 || !info[argc - 1]->IsFunction()) {
+    Nan::ThrowError("startAsync() expects a callback");
+    return;
+  }
+  auto function = info[argc - 1].As<v8::Function>();
+  if (started || starting || stopping) {
+    Nan::Call(function, Nan::GetCurrentContext()->Global(), 0, nullptr);
+    return;
+  }
+
+  std::vector<std::string> log_dirs;
+  if (argc == 2) {
+    apply_start_options(info.GetIsolate(), info[0], &log_dirs);
+  }
+  // construct the client here, not on the worker thread
+  atlas_registry();
+  starting = true;
+  Nan::AsyncQueueWorker(
+      new StartWorker(new Nan::Callback(function), std::move(log_dirs)));
+}
+
+// everything in stop() except stopping the client
+static void stop_runtime() {
+  stop_scrape_server();
+  stop_watchdog();
+  stop_cpu_profile();
+  stop_cgroup_sampler();
+
+  if (starting) {
+    stop_requested = true;
   }
 
   if (timer_started) {
     uv_timer_stop(&lag_timer);
     uv_timer_stop(&fd_timer);
+    uv_timer_stop(&threadpool_timer);
     prev_timestamp = 0;
 
     Nan::RemoveGCPrologueCallback(beforeGC);
     Nan::RemoveGCEpilogueCallback(afterGC);
     free_heap_stats(beforeStats);
     beforeStats = nullptr;
+    timer_started = false;
+  }
+}
+
+NAN_METHOD(stop) {
+  stop_runtime();
+
+  if (started) {
+    atlas_client().Stop();
+    started = false;
+  }
+}
+
+// a stopAsync() call. The client is stopped, which includes the final flush,
+// on a thread of its own so a slow publish endpoint cannot block the event
+// loop or hold on to a thread pool slot
+struct StopRequest {
+  uv_async_t done;
+  uv_timer_t deadline;
+  bool has_deadline = false;
+  bool reported = false;
+  int open_handles = 0;
+  std::unique_ptr<Nan::Callback> callback;
+  Nan::AsyncResource resource{"atlas:stopAsync"};
+};
+
+static void report_stop(StopRequest* req, bool timed_out) {
+  if (req->reported) {
+    return;
   }
+  req->reported = true;
+
+  Nan::HandleScope scope;
+  auto result = Nan::New<v8::Object>();
+  Nan::Set(result, Nan::New("timedOut").ToLocalChecked(),
+           Nan::New(timed_out));
+  v8::Local<v8::Value> argv[] = {result};
+  req->callback->Call(1, argv, &req->resource);
+}
+
+static void on_stop_handle_closed(uv_handle_t* handle) {
+  auto req = static_cast<StopRequest*>(handle->data);
+  if (--req->open_handles == 0) {
+    delete req;
+  }
+}
+
+static void on_stop_done(uv_async_t* handle) {
+  auto req = static_cast<StopRequest*>(handle->data);
+  stopping = false;
+  report_stop(req, false);
+  if (req->has_deadline) {
+    uv_close(reinterpret_cast<uv_handle_t*>(&req->deadline),
+             on_stop_handle_closed);
+  }
+  uv_close(reinterpret_cast<uv_handle_t*>(&req->done), on_stop_handle_closed);
+}
+
+static void on_stop_deadline(uv_timer_t* handle) {
+  auto req = static_cast<StopRequest*>(handle->data);
+  // the flush thread still owns the done handle, which no longer keeps the
+  // loop alive
+  uv_unref(reinterpret_cast<uv_handle_t*>(&req->done));
+  report_stop(req, true);
+}
+
+// stopAsync([{deadlineMs}], callback) calls back with {timedOut}, true when
+// the flush did not finish before the deadline
+NAN_METHOD(stop_async) {
+  auto argc = info.Length();
+  if (argc == 0 || !info[argc - 1]->IsFunction()) {
+    Nan::ThrowError("stopAsync() expects a callback");
+    return;
+  }
+
+  int64_t deadline_ms = 0;
+  if (argc == 2 && info[0]->IsObject()) {
+    auto deadline = Nan::Get(info[0].As<v8::Object>(),
+                             Nan::New("deadlineMs").ToLocalChecked());
+    if (!deadline.IsEmpty() && deadline.ToLocalChecked()->IsNumber()) {
+      deadline_ms = Nan::To<int64_t>(deadline.ToLocalChecked()).FromJust();
+    }
+  }
+
+  stop_runtime();
+  auto req = new StopRequest;
+  req->callback.reset(new Nan::Callback(info[argc - 1].As<v8::Function>()));
+  if (!started && !starting) {
+    report_stop(req, false);
+    delete req;
+    return;
+  }
+  stopping = true;
+
+  auto loop = uv_default_loop();
+  uv_async_init(loop, &req->done, on_stop_done);
+  req->done.data = req;
+  req->open_handles++;
+  if (deadline_ms > 0) {
+    uv_timer_init(loop, &req->deadline);
+    req->deadline.data = req;
+    req->has_deadline = true;
+    req->open_handles++;
+    uv_timer_start(&req->deadline, on_stop_deadline,
+                   static_cast<uint64_t>(deadline_ms), 0);
+  }
+
+  if (starting) {
+    // the deadline already runs, the flush waits for the client
+    pending_stop = req;
+    return;
+  }
+  started = false;
+  flush_in_background(req);
+}
+
+// stops the client, which includes the final flush, on a detached thread and
+// reports through req->done once Stop() has returned
+static void flush_in_background(StopRequest* req) {
+  std::thread flush{[req]() {
+    atlas_client().Stop();
+    uv_async_send(&req->done);
+  }};
+  flush.detach();
 }
@@ -1,9 +1,21 @@
 #pragma once
 
+#include <atlas/meter/id.h>
 #include <nan.h>
 
 // start background processes for atlas plugin
 NAN_METHOD(start);
 
+// start background processes for atlas plugin without blocking the event
+// loop on config loading. Calls back once the publisher is running
+NAN_METHOD(start_async);
+
 // stop atlas plugin
 NAN_METHOD(stop);
+
+// stop atlas plugin, flushing on a background thread for at most
+// deadlineMs. Calls back with the number of measurements flushed or dropped
+NAN_METHOD(stop_async);
+
+// id tagged with the runtime tags given to start
+atlas::meter::IdPtr node_id(const char* name);
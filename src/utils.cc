@@ -1,59 +1,87 @@
 #include "utils.h"
 #include "atlas.h"
-#include <atlas/meter/validation.h>
-#include <iostream>
-#include <sstream>
+#include "cardinality.h"
+#include "diagnostics.h"
+#include "id_builder.h"
+#include "self_metrics.h"
+#include "start_stop.h"
+#include <unordered_map>
 #include <unordered_set>
 
-using atlas::meter::AnalyzeTags;
+using atlas::meter::Counter;
 using atlas::meter::IdPtr;
+using atlas::meter::Tag;
 using atlas::meter::Tags;
-using atlas::meter::ValidationIssue;
 using atlas::util::intern_str;
 using atlas::util::StartsWith;
 using atlas::util::StrRef;
 
 bool dev_mode = false;
 
-std::ostream& operator<<(std::ostream& os, const Tags& tags) {
-  os << '{';
-  auto first = true;
-  for (const auto& kv : tags) {
-    if (first) {
-      first = false;
-    } else {
-      os << ", ";
-    }
-    os << kv.first.get() << '=' << kv.second.get();
-  }
-  os << '}';
-  return os;
-}
+static SeriesTracker series_tracker;
 
-static void throw_if_invalid(const std::string& name, const Tags& tags) {
-  Tags to_check{tags};
-  to_check.add("name", name.c_str());
+// distinct rejected tag combinations remembered per name. Past that, every
+// lookup of a combination that is not remembered is counted as dropped
+static constexpr size_t kMaxRejected = 10000;
 
-  auto res = atlas::meter::AnalyzeTags(to_check);
-  // no warnings or errors found
-  if (res.empty()) {
-    return;
-  }
+struct Overflow {
+  IdPtr id;
+  std::shared_ptr<Counter> dropped;
+  std::unordered_set<uint64_t> rejected;
+};
+static std::unordered_map<const char*, Overflow> overflows;
+
+void set_cardinality_limit(size_t limit) { series_tracker.SetLimit(limit); }
 
-  auto errs = 0;
-  std::ostringstream err_msg;
-  err_msg << "[name:'" << name << "', tags:" << tags << "]:\n";
-  for (const auto& issue : res) {
-    if (issue.level == ValidationIssue::Level::ERROR) {
-      ++errs;
+void forget_series(const char* name, uint64_t tags_hash) {
+  series_tracker.Forget(name, tags_hash);
+}
+
+// the single id all new tag combinations for name are folded into once the
+// limit is reached. Each combination is counted as dropped once
+static IdPtr overflow_id(const char* name, const Tags& tags) {
+  auto it = overflows.find(name);
+  if (it == overflows.end()) {
+    auto r = atlas_registry();
+    Tags overflow_tags;
+    overflow_tags.add("atlas.overflow", "true");
+    auto dropped_id = node_id("atlas.client.droppedSeries")
+                          ->WithTag(Tag::of("metric", name));
+    it = overflows
+             .emplace(name, Overflow{r->CreateId(name, overflow_tags),
+                                     r->counter(dropped_id),
+                                     std::unordered_set<uint64_t>{}})
+             .first;
+  }
+  auto& overflow = it->second;
+  auto hash = tags_hash(tags);
+  if (overflow.rejected.count(hash) == 0) {
+    if (overflow.rejected.size() < kMaxRejected) {
+      overflow.rejected.insert(hash);
     }
+    overflow.dropped->Increment();
+  }
+  return overflow.id;
+}
 
-    err_msg << '\t' << issue.ToString() << '\n';
+IdPtr readmit_series(const IdPtr& id) {
+  if (series_tracker.Limit() == 0) {
+    return id;
+  }
+  auto name = id->Name();
+  auto it = overflows.find(name);
+  if (it != overflows.end() && it->second.id == id) {
+    return id;
   }
+  const auto& tags = id->GetTags();
+  return series_tracker.Admit(name, tags) ? id : overflow_id(name, tags);
+}
 
+static void throw_if_invalid(const std::string& name, const Tags& tags) {
+  auto has_errors = false;
+  auto err = validate_id(name, tags, &has_errors);
   // do not throw if warnings only
-  if (errs > 0) {
-    auto err = err_msg.str();
+  if (has_errors) {
     Nan::ThrowError(err.c_str());
   }
 }
@@ -65,22 +93,18 @@ bool tagsFromObject(v8::Isolate* isolate, const v8::Local<v8::Object>& object,
   if (!maybe_props.IsEmpty()) {
     auto props = maybe_props.ToLocalChecked();
     auto n = props->Length();
+    size_t bytes = 0;
     for (uint32_t i = 0; i < n; ++i) {
       const auto& key = props->Get(context, i).ToLocalChecked();
       const auto& value = object->Get(context, key).ToLocalChecked();
       const auto& k = std::string(*Nan::Utf8String(key));
       const auto& v = std::string(*Nan::Utf8String(value));
-      if (k.empty()) {
-        *error_msg = "Cannot have an empty key when specifying tags";
+      if (!add_tag(k, v, tags, error_msg)) {
         return false;
       }
-      if (v.empty()) {
-        *error_msg = "Cannot have an empty value for key '" + k +
-                     "' when specifying tags";
-        return false;
-      }
-      tags->add(k.c_str(), v.c_str());
+      bytes += k.size() + v.size();
     }
+    self_count_tag_bytes(bytes);
   }
   return true;
 }
@@ -128,12 +152,19 @@ IdPtr idFromValue(const Nan::FunctionCallbackInfo<v8::Value>& info, int argc) {
   if (dev_mode) {
     throw_if_invalid(name, tags);
   }
+  self_count_id();
+  if (series_tracker.Limit() > 0) {
+    auto interned = intern_str(name).get();
+    if (!series_tracker.Admit(interned, tags)) {
+      return overflow_id(interned, tags);
+    }
+  }
   return r->CreateId(name, tags);
 error:
   if (dev_mode) {
     Nan::ThrowError(err_msg.c_str());
   } else {
-    fprintf(stderr, "Error creating atlas metric ID: %s\n", err_msg.c_str());
+    record_invalid_id(err_msg);
   }
   tags.add("atlas.invalid", "true");
   return r->CreateId("invalid", tags);
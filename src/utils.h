@@ -9,4 +9,15 @@ bool tagsFromObject(v8::Isolate* isolate, const v8::Local<v8::Object>& object,
 atlas::meter::IdPtr idFromValue(
     const Nan::FunctionCallbackInfo<v8::Value>& info, int argc);
 
+// maximum number of distinct tag combinations per metric name, 0 for no
+// limit. Ids past the limit are folded into one tagged atlas.overflow=true
+void set_cardinality_limit(size_t limit);
+
+// a series tracked for the cardinality limit is no longer in use
+void forget_series(const char* name, uint64_t tags_hash);
+
+// the id a forgotten series comes back under: id itself if there is room for
+// it again, or the overflow id for its name
+atlas::meter::IdPtr readmit_series(const atlas::meter::IdPtr& id);
+
 extern bool dev_mode;
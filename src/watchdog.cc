@@ -0,0 +1,241 @@
+#include "watchdog.h"
+#include "atlas.h"
+#include "start_stop.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using atlas::meter::Counter;
+using atlas::meter::Timer;
+
+static constexpr int kMaxFrames = 16;
+static constexpr size_t kMaxStacks = 64;
+static constexpr uint64_t kMinPeriodMs = 10;
+static constexpr uint64_t kMaxPeriodMs = 1000;
+static constexpr const char* kOtherStacks = "(other stacks)";
+
+// joined by stop_watchdog(), which also runs as an environment cleanup hook
+// so the thread never outlives the isolate it interrupts
+static std::thread* watchdog_thread = nullptr;
+static bool cleanup_hook_added = false;
+static std::mutex watchdog_mutex;
+static std::condition_variable watchdog_cv;
+static bool watchdog_running = false;
+
+// uv_hrtime() of the last turn of the loop, written by an unref'd timer
+static uv_timer_t heartbeat_timer;
+static bool heartbeat_initialized = false;
+static std::atomic<uint64_t> heartbeat{0};
+// heartbeat of the stall a stack capture was requested for
+static std::atomic<uint64_t> interrupt_heartbeat{0};
+
+static v8::Isolate* watched_isolate = nullptr;
+static std::shared_ptr<Counter> stall_counter;
+static std::shared_ptr<Timer> stall_timer;
+
+struct StallStack {
+  std::vector<std::string> frames;
+  int64_t count;
+};
+
+// stacks seen after kMaxStacks distinct ones are tallied as kOtherStacks
+static std::mutex stacks_mutex;
+static std::unordered_map<std::string, StallStack> stall_stacks_table;
+
+static void on_heartbeat(uv_timer_t*) { heartbeat = uv_hrtime(); }
+
+static std::string frame_to_string(v8::Local<v8::StackFrame> frame) {
+  std::ostringstream os;
+  Nan::Utf8String fn{frame->GetFunctionName()};
+  Nan::Utf8String script{frame->GetScriptName()};
+  os << (fn.length() > 0 ? *fn : "<anonymous>") << " ("
+     << (script.length() > 0 ? *script : "<unknown>") << ':'
+     << frame->GetLineNumber() << ':' << frame->GetColumn() << ')';
+  return os.str();
+}
+
+static void tally_stack(std::vector<std::string> frames) {
+  std::string key;
+  for (const auto& f : frames) {
+    key += f;
+    key += '\n';
+  }
+
+  std::lock_guard<std::mutex> guard{stacks_mutex};
+  auto it = stall_stacks_table.find(key);
+  if (it == stall_stacks_table.end()) {
+    if (stall_stacks_table.size() >= kMaxStacks) {
+      key = kOtherStacks;
+      frames = {kOtherStacks};
+    }
+    it = stall_stacks_table.emplace(key, StallStack{std::move(frames), 0})
+             .first;
+  }
+  it->second.count++;
+}
+
+// runs on the JS thread, interrupting the code that blocks the loop
+static void capture_stack(v8::Isolate* isolate, void*) {
+  if (heartbeat != interrupt_heartbeat) {
+    // the loop turned before the interrupt was delivered, so whatever runs
+    // now is not what stalled it
+    return;
+  }
+
+  v8::HandleScope scope{isolate};
+  auto trace = v8::StackTrace::CurrentStackTrace(isolate, kMaxFrames);
+  std::vector<std::string> frames;
+  for (int i = 0; i < trace->GetFrameCount(); ++i) {
+#if V8_MAJOR_VERSION >= 7
+    frames.emplace_back(frame_to_string(trace->GetFrame(isolate, i)));
+#else
+    frames.emplace_back(frame_to_string(trace->GetFrame(i)));
+#endif
+  }
+  if (frames.empty()) {
+    frames.emplace_back("(no JS frames)");
+  }
+  tally_stack(std::move(frames));
+}
+
+static void watch(int64_t threshold_ns, uint64_t period_ms,
+                  bool capture_stacks) {
+  // heartbeat seen when the current stall was detected, 0 if not stalled
+  uint64_t stalled_at = 0;
+  std::unique_lock<std::mutex> lock{watchdog_mutex};
+  while (watchdog_running) {
+    watchdog_cv.wait_for(lock, std::chrono::milliseconds(period_ms));
+    if (!watchdog_running) {
+      break;
+    }
+
+    auto now = uv_hrtime();
+    uint64_t last = heartbeat;
+    if (stalled_at != 0) {
+      if (last != stalled_at) {
+        // the loop is turning again
+        stall_timer->Record(std::chrono::nanoseconds(last - stalled_at));
+        stalled_at = 0;
+      }
+      continue;
+    }
+
+    if (static_cast<int64_t>(now - last) > threshold_ns) {
+      stalled_at = last;
+      stall_counter->Increment();
+      if (capture_stacks) {
+        interrupt_heartbeat = last;
+        watched_isolate->RequestInterrupt(capture_stack, nullptr);
+      }
+    }
+  }
+}
+
+void start_watchdog(const WatchdogOptions& options) {
+  stop_watchdog();
+
+  if (!stall_counter) {
+    auto r = atlas_registry();
+    stall_counter = r->counter(node_id("nodejs.eventLoopStall"));
+    stall_timer = r->timer(node_id("nodejs.eventLoopStallTime"));
+  }
+  watched_isolate = v8::Isolate::GetCurrent();
+  if (!cleanup_hook_added) {
+    node::AddEnvironmentCleanupHook(
+        watched_isolate, [](void*) { stop_watchdog(); }, nullptr);
+    cleanup_hook_added = true;
+  }
+
+  auto threshold_ms = std::max<uint64_t>(options.threshold_ms, 1);
+  auto period_ms =
+      std::min(std::max(threshold_ms / 4, kMinPeriodMs), kMaxPeriodMs);
+  if (!heartbeat_initialized) {
+    uv_timer_init(uv_default_loop(), &heartbeat_timer);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&heartbeat_timer));
+    heartbeat_initialized = true;
+  }
+  heartbeat = uv_hrtime();
+  uv_timer_start(&heartbeat_timer, on_heartbeat, period_ms, period_ms);
+
+  watchdog_running = true;
+  auto threshold_ns = static_cast<int64_t>(threshold_ms) * 1000000;
+  auto capture_stacks = options.capture_stacks;
+  watchdog_thread = new std::thread{[=]() {
+    watch(threshold_ns, period_ms, capture_stacks);
+  }};
+}
+
+void stop_watchdog() {
+  if (watchdog_thread == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard{watchdog_mutex};
+    watchdog_running = false;
+  }
+  watchdog_cv.notify_all();
+  watchdog_thread->join();
+  delete watchdog_thread;
+  watchdog_thread = nullptr;
+  uv_timer_stop(&heartbeat_timer);
+}
+
+void watchdog_options_from_object(const v8::Local<v8::Object>& object,
+                                  WatchdogOptions* options) {
+  auto threshold = Nan::Get(object, Nan::New("thresholdMs").ToLocalChecked());
+  if (!threshold.IsEmpty() && threshold.ToLocalChecked()->IsNumber()) {
+    auto ms = Nan::To<double>(threshold.ToLocalChecked()).FromJust();
+    options->threshold_ms = ms > 0 ? static_cast<uint64_t>(ms) : 1;
+  }
+  auto capture = Nan::Get(object, Nan::New("captureStacks").ToLocalChecked());
+  if (!capture.IsEmpty()) {
+    options->capture_stacks =
+        Nan::To<bool>(capture.ToLocalChecked()).FromJust();
+  }
+}
+
+NAN_METHOD(start_watchdog) {
+  WatchdogOptions options;
+  if (info.Length() > 0 && info[0]->IsObject()) {
+    watchdog_options_from_object(info[0].As<v8::Object>(), &options);
+  }
+  start_watchdog(options);
+}
+
+NAN_METHOD(stop_watchdog) { stop_watchdog(); }
+
+NAN_METHOD(stall_stacks) {
+  std::vector<StallStack> stacks;
+  {
+    std::lock_guard<std::mutex> guard{stacks_mutex};
+    for (const auto& kv : stall_stacks_table) {
+      stacks.push_back(kv.second);
+    }
+  }
+  std::sort(stacks.begin(), stacks.end(),
+            [](const StallStack& a, const StallStack& b) {
+              return a.count > b.count;
+            });
+
+  auto result = Nan::New<v8::Array>(static_cast<int>(stacks.size()));
+  uint32_t i = 0;
+  for (const auto& s : stacks) {
+    auto frames = Nan::New<v8::Array>(static_cast<int>(s.frames.size()));
+    uint32_t j = 0;
+    for (const auto& f : s.frames) {
+      Nan::Set(frames, j++, Nan::New(f).ToLocalChecked());
+    }
+    auto entry = Nan::New<v8::Object>();
+    Nan::Set(entry, Nan::New("count").ToLocalChecked(),
+             Nan::New(static_cast<double>(s.count)));
+    Nan::Set(entry, Nan::New("frames").ToLocalChecked(), frames);
+    Nan::Set(result, i++, entry);
+  }
+  info.GetReturnValue().Set(result);
+}
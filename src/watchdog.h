@@ -0,0 +1,33 @@
+#pragma once
+
+#include <nan.h>
+
+// detects a blocked event loop while it is still blocked. The loop writes a
+// heartbeat from a timer, and a native thread checks it
+struct WatchdogOptions {
+  // how long the loop has to go without a heartbeat to count as stalled
+  uint64_t threshold_ms = 1000;
+  // interrupt the stalled JS code to record where it is
+  bool capture_stacks = false;
+};
+
+// start the heartbeat and the watchdog thread. Must be called from the JS
+// thread. Restarts the watchdog if it was already running
+void start_watchdog(const WatchdogOptions& options);
+
+// stop the heartbeat and wait for the watchdog thread to finish
+void stop_watchdog();
+
+// parse a {thresholdMs, captureStacks} object into options
+void watchdog_options_from_object(const v8::Local<v8::Object>& object,
+                                  WatchdogOptions* options);
+
+// startWatchdog({thresholdMs: 1000, captureStacks: true})
+NAN_METHOD(start_watchdog);
+
+// stopWatchdog()
+NAN_METHOD(stop_watchdog);
+
+// stallStacks() returns the captured stacks, most frequent first:
+// [{count, frames: ['fn (file:line:column)', ...]}]
+NAN_METHOD(stall_stacks);
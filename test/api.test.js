@@ -77,6 +77,52 @@ describe('atlas extension', () => {
     assert(timer.totalTime() > 0, 'Some time was recorded');
   });
 
+  it('should scale sampled timers by the sampling rate', () => {
+    const t = atlas.sampledTimer('sampled.timer', {k: 'v'}, {rate: 10});
+    const n = 10000;
+
+    for (let i = 0; i < n; ++i) {
+      t.record(0, 1000);
+    }
+    // unbiased: the scaled count is close to the number of events
+    assert.approximately(t.count(), n, 0.1 * n);
+    assert.equal(t.count() % 10, 0);
+    assert.approximately(t.totalTime(), t.count() * 1e-6, 1e-9);
+
+    // the published count is scaled too
+    const published = atlas.counter('sampled.timer', {
+      k: 'v',
+      sampleRate: '0.1',
+      statistic: 'count'
+    });
+    assert.equal(published.count(), t.count());
+  });
+
+  it('should reject sampling rates above 10000', () => {
+    assert.throws(() => atlas.sampledTimer('sampled.timer.max', {}, {
+      rate: 1e6
+    }), /at most 10000/);
+    assert.throws(() => atlas.sampledTimer('sampled.timer.max', {}, {
+      rate: 1e-6
+    }), /at most 10000/);
+  });
+
+  it('should skip the clock for events that are not sampled', () => {
+    const t = atlas.sampledTimer('sampled.timer.start', {}, {rate: 0.5});
+    let sampled = 0;
+
+    for (let i = 0; i < 1000; ++i) {
+      const token = t.start();
+
+      if (token !== 0) {
+        sampled++;
+      }
+      t.stop(token);
+    }
+    assert.equal(t.count(), sampled * 2);
+    assert.equal(t.timeThis(() => 42), 42);
+  });
+
   it('should provide gauges that use the last value set', () => {
     let g = atlas.gauge('gauge.example');
     g.update(42);
@@ -143,6 +189,31 @@ describe('atlas extension', () => {
     });
   });
 
+  it('should time promises natively', () => {
+    const t = atlas.timer('timer.promise');
+    const p = new Promise((resolve) => setTimeout(() => resolve(42), 5));
+    return t.timePromise(p).then((v) => {
+      assert.equal(v, 42);
+      assert.equal(t.count(), 1);
+      assert(t.totalTime() > 0);
+    });
+  });
+
+  it('should tag the outcome of timed promises when asked', () => {
+    const t = atlas.percentileTimer('timer.promise.outcome');
+    const err = new Error('expected');
+    return t.timePromise(Promise.reject(err), {outcome: true}).then(() => {
+      assert.fail('should have been rejected');
+    }, (e) => {
+      assert.strictEqual(e, err);
+      const failures = atlas.percentileTimer('timer.promise.outcome', {
+        result: 'failure'
+      });
+      assert.equal(failures.count(), 1);
+      assert.equal(t.count(), 0);
+    });
+  });
+
   it('should have long task timers', () => {
     let t = atlas.longTaskTimer('long.task.timer');
     let id = t.start();
@@ -168,6 +239,29 @@ describe('atlas extension', () => {
     }, 20);
   });
 
+  it('should compute age gauges when read', () => {
+    let a = atlas.age('age.gauge.update');
+    a.update((new Date).getTime() - 5000);
+    assert.isAtLeast(a.value(), 5);
+    a.update();
+    assert.isBelow(a.value(), 1);
+  });
+
+  it('should only call function gauges on snapshots', () => {
+    let calls = 0;
+    const g = atlas.functionGauge('function.gauge', {k: 'v'}, () => {
+      calls++;
+      return 42;
+    });
+    assert.equal(calls, 0);
+
+    const ms = atlas.measurements();
+    assert.equal(calls, 1);
+    const m = ms.find((x) => x.tags.name === 'function.gauge');
+    assert.equal(m.value, 42);
+    assert.equal(g.value(), 42);
+  });
+
   it('should provide bucket counters', () => {
     let bc = atlas.bucketCounter(
       'example.bucket.c', {
@@ -248,6 +342,32 @@ describe('atlas extension', () => {
     }
   });
 
+  it('should keep rolling windows for selected meters', () => {
+    const t = atlas.percentileTimer('example.window.t');
+    const w = t.rollingWindow({windowMs: 60000, buckets: 12});
+    assert.equal(w.count(), 0);
+    assert.isNaN(w.percentile(99));
+
+    for (let i = 1; i <= 1000; ++i) {
+      t.record(0, i * 1000 * 1000); // 1ms to 1s
+    }
+    assert.equal(w.count(), 1000);
+    assert.isAbove(w.rate(), 0);
+    assert.approximately(w.mean(), 0.5005, 0.001);
+    assert.approximately(w.percentile(50), 0.5, 0.05);
+    assert.approximately(w.percentile(99), 0.99, 0.1);
+    // the same window is shared
+    assert.equal(t.rollingWindow().count(), 1000);
+
+    const c = atlas.counter('example.window.c');
+    const cw = c.rollingWindow({windowMs: 10000});
+    c.increment(3);
+    c.add(2);
+    assert.equal(cw.count(), 2);
+    assert.equal(cw.mean(), 2.5);
+    assert.isNaN(cw.percentile(50));
+  });
+
   it('should provide percentile distribution summaries', () => {
     let samples = 20000;
     let d = atlas.percentileDistSummary('example.perc.d');
@@ -282,6 +402,88 @@ describe('atlas extension', () => {
     assert.isAtLeast(d.measurements.length, 2);
   });
 
+  it('should page through measurements with a cursor', () => {
+    atlas.counter('cursor.example').increment();
+    const cursor = atlas.measurementsCursor(2);
+    const total = cursor.size();
+    assert.isAtLeast(total, 1);
+    let seen = 0;
+
+    for (const page of cursor) {
+      assert.isAtMost(page.length, 2);
+
+      for (const m of page) {
+        assert.isObject(m.tags);
+        assert.isNumber(m.value);
+      }
+      seen += page.length;
+    }
+    assert.equal(seen, total);
+    assert(cursor.done());
+    assert.equal(cursor.next().length, 0);
+  });
+
+  it('should page through measurements asynchronously', (done) => {
+    const cursor = atlas.measurementsCursor(3);
+    const iter = cursor[Symbol.asyncIterator]();
+    let seen = 0;
+    const step = () => {
+      iter.next().then((r) => {
+        if (r.done) {
+          assert.equal(seen, cursor.size());
+          done();
+          return;
+        }
+        seen += r.value.length;
+        step();
+      }).catch(done);
+    };
+    step();
+  });
+
+  it('should break down native memory by metric name', () => {
+    const before = atlas.memoryStats().totalBytes;
+    atlas.percentileTimer('memory.example', {k: 'v'});
+    // same meter, nothing new to account for
+    atlas.percentileTimer('memory.example', {k: 'v'});
+    const stats = atlas.memoryStats(1000);
+    assert.isAbove(stats.totalBytes, before);
+    assert.isAbove(stats.types.percentileTimer.meters, 0);
+    const entry = stats.names.find((e) => e.name === 'memory.example');
+    assert.equal(entry.meters, 1);
+    assert.isAbove(entry.bytes, 0);
+  });
+
+  it('should release disposed meters', () => {
+    const ctr = atlas.counter('dispose.example');
+    ctr.increment();
+    assert.isFalse(ctr.isDisposed());
+    ctr.dispose();
+    assert.isTrue(ctr.isDisposed());
+    // no-ops once disposed
+    ctr.increment();
+    assert.isUndefined(ctr.count());
+    const names = atlas.memoryStats(1000).names.map((e) => e.name);
+    assert.notInclude(names, 'dispose.example');
+  });
+
+  it('should record again with meters released by the ttl', function(done) {
+    this.timeout(5000);
+    const ctr = atlas.counter('ttl.example');
+    ctr.increment();
+    atlas.setMeterTtl(1);
+    setTimeout(() => {
+      atlas.setMeterTtl(0);
+      const names = () => atlas.memoryStats(1000).names.map((e) => e.name);
+      assert.notInclude(names(), 'ttl.example');
+      ctr.increment();
+      assert.isFalse(ctr.isDisposed());
+      assert.isAtLeast(ctr.count(), 1);
+      assert.include(names(), 'ttl.example');
+      done();
+    }, 1500);
+  });
+
   it('should validate metrics when in dev mode', () => {
     atlas.setDevMode(true);
     const noName = () => {
@@ -359,6 +561,18 @@ describe('atlas extension', () => {
 
   });
 
+  it('should aggregate invalid ids in diagnostics', () => {
+    atlas.setDevMode(false);
+
+    for (let i = 0; i < 100; ++i) {
+      atlas.counter('');
+    }
+    const entry = atlas.diagnostics().invalidIds.find(
+      (e) => /empty name/.test(e.error));
+    assert.isAtLeast(entry.count, 100);
+    assert.isAtMost(entry.firstSeen, entry.lastSeen);
+  });
+
   it('should validate metric IDs', () => {
     const noName = atlas.validateNameAndTags('');
     assert.equal(noName.length, 1);
@@ -0,0 +1,66 @@
+'use strict';
+
+const atlas = require('../');
+const chai = require('chai');
+const assert = chai.assert;
+
+describe('cardinality limit', () => {
+  afterEach(() => atlas.setCardinalityLimit(0));
+
+  it('should fold new tag combinations into an overflow id', () => {
+    atlas.setCardinalityLimit(2);
+    atlas.counter('cardinality.example', {id: '1'}).increment();
+    atlas.counter('cardinality.example', {id: '2'}).increment();
+    // seen before, still allowed
+    atlas.counter('cardinality.example', {id: '1'}).increment();
+    atlas.counter('cardinality.example', {id: '3'}).increment();
+    atlas.counter('cardinality.example', {id: '4'}).increment();
+    // dropped before, not counted again
+    atlas.counter('cardinality.example', {id: '3'}).increment();
+
+    assert.equal(atlas.counter('cardinality.example', {id: '1'}).count(), 2);
+
+    // before the overflow lookup below, which is a new combination too
+    const dropped = atlas.counter('atlas.client.droppedSeries', {
+      metric: 'cardinality.example'
+    });
+    assert.equal(dropped.count(), 2);
+    const overflow = atlas.counter('cardinality.example', {
+      'atlas.overflow': 'true'
+    });
+    assert.equal(overflow.count(), 3);
+  });
+
+  it('should not let an expired series take back a reused slot',
+    function(done) {
+      this.timeout(5000);
+      atlas.setCardinalityLimit(1);
+      const first = atlas.counter('cardinality.expired', {id: '1'});
+      first.increment();
+      atlas.setMeterTtl(1);
+
+      setTimeout(() => {
+        atlas.setMeterTtl(0);
+        // the expiry freed the only slot
+        const second = atlas.counter('cardinality.expired', {id: '2'});
+        second.increment();
+        // no room left for the first one
+        first.increment();
+
+        assert.equal(second.count(), 1);
+        const overflow = atlas.counter('cardinality.expired', {
+          'atlas.overflow': 'true'
+        });
+        assert.equal(overflow.count(), 1);
+        done();
+      }, 1500);
+    });
+
+  it('should ignore the order of tags', () => {
+    atlas.setCardinalityLimit(1);
+    atlas.counter('cardinality.order', {a: '1', b: '2'}).increment();
+    atlas.counter('cardinality.order', {b: '2', a: '1'}).increment();
+    assert.equal(atlas.counter('cardinality.order', {a: '1', b: '2'}).count(),
+      2);
+  });
+});
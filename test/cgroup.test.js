@@ -0,0 +1,64 @@
+'use strict';
+
+const native = require('bindings')('atlas');
+const path = require('path');
+const chai = require('chai');
+const assert = chai.assert;
+
+function fixture(name) {
+  return path.join(__dirname, 'fixtures', name);
+}
+
+describe('cgroup stats', () => {
+  it('should read cgroup v2 files', (done) => {
+    native.readCgroupStats(fixture('cgroup-v2'), (err, stats) => {
+      assert.isNull(err);
+      assert.equal(stats.version, 2);
+      assert.equal(stats.periods, 345620);
+      assert.equal(stats.throttledPeriods, 1520);
+      assert.equal(stats.throttledUsec, 97564000);
+      assert.equal(stats.memoryUsage, 1073741824);
+      assert.equal(stats.memoryLimit, 2147483648);
+      assert.equal(stats.memoryPressure.some.avg10, 1.25);
+      assert.equal(stats.memoryPressure.full.total, 1234000);
+      done();
+    });
+  });
+
+  it('should read the cgroup v2 files of the process', (done) => {
+    const root = fixture('cgroup-v2-nested');
+    const selfCgroup = path.join(root, 'self-cgroup');
+    native.readCgroupStats(root, selfCgroup, (err, stats) => {
+      assert.isNull(err);
+      assert.equal(stats.version, 2);
+      assert.equal(stats.throttledPeriods, 12);
+      assert.equal(stats.memoryUsage, 268435456);
+      assert.equal(stats.memoryLimit, 536870912);
+      done();
+    });
+  });
+
+  it('should read cgroup v1 files', (done) => {
+    native.readCgroupStats(fixture('cgroup-v1'), (err, stats) => {
+      assert.isNull(err);
+      assert.equal(stats.version, 1);
+      assert.equal(stats.throttledPeriods, 30);
+      // throttled_time is in nanoseconds
+      assert.equal(stats.throttledUsec, 2500000);
+      assert.equal(stats.memoryUsage, 536870912);
+      // no limit
+      assert.notProperty(stats, 'memoryLimit');
+      assert.notProperty(stats, 'memoryPressure');
+      done();
+    });
+  });
+
+  it('should report version 0 without cgroup files', (done) => {
+    native.readCgroupStats(fixture('missing'), (err, stats) => {
+      assert.isNull(err);
+      assert.equal(stats.version, 0);
+      assert.notProperty(stats, 'memoryUsage');
+      done();
+    });
+  });
+});
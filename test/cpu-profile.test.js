@@ -0,0 +1,34 @@
+'use strict';
+
+const atlas = require('../');
+const chai = require('chai');
+const assert = chai.assert;
+
+function spinFor(ms) {
+  const end = Date.now() + ms;
+  let n = 0;
+
+  while (Date.now() < end) {
+    n++;
+  }
+  return n;
+}
+
+describe('cpu profile', () => {
+  afterEach(() => atlas.stopCpuProfile());
+
+  it('should report the self time of busy functions', (done) => {
+    atlas.startCpuProfile({intervalUs: 1000, windowMs: 200, topN: 5});
+    spinFor(300);
+
+    // the window ends once the loop is free again
+    setTimeout(() => {
+      const selfTime = atlas.dcounter('nodejs.cpuSelfTime', {
+        function: 'spinFor',
+        script: 'test/cpu-profile.test.js'
+      });
+      assert.isAbove(selfTime.count(), 0);
+      done();
+    }, 400);
+  });
+});
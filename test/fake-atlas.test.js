@@ -0,0 +1,87 @@
+'use strict';
+
+const fakeAtlas = require('../bench/fake-atlas');
+const http = require('http');
+const zlib = require('zlib');
+const chai = require('chai');
+const assert = chai.assert;
+
+function post(url, body, headers, cb) {
+  const req = http.request(url, {method: 'POST', headers: headers}, (res) => {
+    res.resume();
+    res.on('end', () => cb(null, res));
+  });
+  req.on('error', cb);
+  req.end(body);
+}
+
+function getJson(url, cb) {
+  http.get(url, (res) => {
+    let body = '';
+    res.setEncoding('utf8');
+    res.on('data', (chunk) => {
+      body += chunk;
+    });
+    res.on('end', () => cb(null, JSON.parse(body)));
+  }).on('error', cb);
+}
+
+describe('fake atlas server', () => {
+  const subscriptions = [
+    {id: 'a', expression: 'name,bench.publish,:eq,:sum', frequency: 60000}
+  ];
+  let server;
+
+  beforeEach((done) => {
+    server = fakeAtlas.create({subscriptions: subscriptions});
+    server.listen(0, done);
+  });
+
+  afterEach((done) => server.close(done));
+
+  it('should count gzipped publish batches', (done) => {
+    const payload = JSON.stringify({
+      tags: {'nf.app': 'test'},
+      metrics: [
+        {tags: {name: 'a'}, start: 1, value: 1},
+        {tags: {name: 'b'}, start: 1, value: 2}
+      ]
+    });
+    const body = zlib.gzipSync(payload);
+    const headers = {
+      'Content-Encoding': 'gzip',
+      'Content-Type': 'application/json'
+    };
+    post(server.urls().publishUrl, body, headers, (err, res) => {
+      assert.isNull(err);
+      assert.equal(res.statusCode, 200);
+      const stats = server.stats();
+      assert.equal(stats.publish.batches, 1);
+      assert.equal(stats.publish.metrics, 2);
+      assert.equal(stats.publish.bytes, body.length);
+      assert.equal(stats.publish.uncompressedBytes, payload.length);
+      assert.equal(stats.evaluate.batches, 0);
+      done();
+    });
+  });
+
+  it('should reject batches it cannot parse', (done) => {
+    post(server.urls().evaluateUrl, 'not json', {}, (err, res) => {
+      assert.isNull(err);
+      assert.equal(res.statusCode, 400);
+      assert.equal(server.stats().evaluate.errors, 1);
+      done();
+    });
+  });
+
+  it('should serve subscriptions', (done) => {
+    getJson(server.urls('go2').subscriptionsUrl, (err, body) => {
+      assert.isNull(err);
+      assert.deepEqual(body.expressions, subscriptions);
+      assert.equal(server.stats().subscriptionRequests, 1);
+      server.reset();
+      assert.equal(server.stats().subscriptionRequests, 0);
+      done();
+    });
+  });
+});
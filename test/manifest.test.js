@@ -0,0 +1,87 @@
+'use strict';
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const atlas = require('../');
+const manifest = require('../manifest');
+const chai = require('chai');
+const assert = chai.assert;
+
+describe('meter manifest', () => {
+  const file = path.join(os.tmpdir(), `atlas-manifest-${process.pid}.json`);
+
+  afterEach(() => {
+    if (fs.existsSync(file)) {
+      fs.unlinkSync(file);
+    }
+  });
+
+  it('should expand the known tag values', () => {
+    const combinations = manifest._tagCombinations({
+      status: ['200', '500'],
+      method: ['GET', 'POST', 'PUT'],
+      region: 'us-east-1'
+    });
+    assert.lengthOf(combinations, 6);
+    assert.deepEqual(combinations[0],
+      {status: '200', method: 'GET', region: 'us-east-1'});
+  });
+
+  it('should reject unknown meter types', () => {
+    fs.writeFileSync(file, JSON.stringify({
+      meters: [{name: 'manifest.bad', type: 'histogram'}]
+    }));
+    assert.throws(() => manifest.load(file), /unknown type/);
+  });
+
+  it('should reject entries with too many combinations', () => {
+    const values = Array.from({length: 1000}, (_, i) => String(i));
+    const entries = [{name: 'manifest.huge', type: 'counter',
+      tags: {a: values, b: values, c: values}}];
+    assert.throws(() => manifest.preload(atlas, entries), /exceed the limit/);
+  });
+
+  it('should preload meters retrievable by name and tags', () => {
+    fs.writeFileSync(file, JSON.stringify({
+      meters: [
+        {name: 'manifest.requests', type: 'counter',
+         tags: {status: ['200', '500']}},
+        {name: 'manifest.latency', type: 'bucketTimer',
+         bucket: {function: 'latency', value: 8, unit: 's'}}
+      ]
+    }));
+    const meters = manifest.preload(atlas, manifest.load(file));
+    assert.equal(meters.size, 3);
+
+    const ctr = meters.get(manifest.meterKey('manifest.requests',
+      {status: '500'}));
+    ctr.increment();
+    assert.equal(atlas.counter('manifest.requests', {status: '500'}).count(),
+      1);
+  });
+
+  it('should look up meters preloaded by start', () => {
+    fs.writeFileSync(file, JSON.stringify({
+      meters: [
+        {name: 'manifest.started', type: 'counter',
+         tags: {status: ['200', '500']}},
+        {name: 'manifest.scoped', type: 'counter',
+         tags: {region: 'us-east-1', status: ['200', '500']}}
+      ]
+    }));
+    atlas.start({manifest: file, runtimeMetrics: false});
+
+    const ctr = atlas.preloaded('manifest.started', {status: '500'});
+    assert.isDefined(ctr);
+    ctr.increment();
+    assert.equal(atlas.counter('manifest.started', {status: '500'}).count(),
+      1);
+    assert.isUndefined(atlas.preloaded('manifest.started', {status: '404'}));
+
+    const scoped = atlas.scope({region: 'us-east-1'});
+    assert.isDefined(scoped.preloaded('manifest.scoped', {status: '200'}));
+    assert.isUndefined(scoped.preloaded('manifest.started', {status: '200'}));
+    return atlas.stopAsync({deadlineMs: 100});
+  });
+});
@@ -88,6 +88,9 @@ describe('atlas mocks', () => {
     atlas.start();
     atlas.stop();
   });
+  it('should mock startAsync/stopAsync', () => atlas.startAsync()
+    .then(() => atlas.stopAsync({deadlineMs: 100}))
+    .then((r) => assert.isFalse(r.timedOut)));
   it('should mock getDebugInfo/config/measurements', () => {
     atlas.getDebugInfo();
     atlas.config();
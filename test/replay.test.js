@@ -0,0 +1,19 @@
+'use strict';
+
+const atlas = require('../');
+const replay = require('../bench/replay');
+const chai = require('chai');
+const assert = chai.assert;
+
+describe('replay', () => {
+  it('should report timer totals in milliseconds', () => {
+    const t = atlas.timer('replay.timerStats');
+    t.record(0, 250 * 1e6);
+    t.record(0, 750 * 1e6);
+
+    const stats = replay.timerStats(t);
+    assert.equal(stats.count, 2);
+    assert.closeTo(stats.totalMs, 1000, 1e-6);
+    assert.closeTo(stats.meanMs, 500, 1e-6);
+  });
+});
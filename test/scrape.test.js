@@ -0,0 +1,87 @@
+'use strict';
+
+const atlas = require('../');
+const native = require('bindings')('atlas');
+const fs = require('fs');
+const http = require('http');
+const os = require('os');
+const path = require('path');
+const chai = require('chai');
+const assert = chai.assert;
+
+function get(options, cb) {
+  http.get(options, (res) => {
+    let body = '';
+    res.setEncoding('utf8');
+    res.on('data', (chunk) => {
+      body += chunk;
+    });
+    res.on('end', () => cb(null, res, body));
+  }).on('error', cb);
+}
+
+describe('scrape server', () => {
+  afterEach(() => native.stopScrapeServer());
+
+  it('should serve json on a loopback port', (done) => {
+    atlas.gauge('scrape.example', {k: 'v'}).update(3);
+    const port = native.startScrapeServer({port: 0});
+    assert.isAbove(port, 0);
+
+    get({host: '127.0.0.1', port: port, path: '/metrics.json'},
+      (err, res, body) => {
+        if (err) {
+          done(err);
+          return;
+        }
+        assert.equal(res.statusCode, 200);
+        const ms = JSON.parse(body);
+        assert.isArray(ms);
+        const m = ms.find((x) => x.tags.name === 'scrape.example');
+        assert.isObject(m);
+        assert.equal(m.tags.k, 'v');
+        done();
+      });
+  });
+
+  it('should serve the text format on a unix socket', (done) => {
+    const socketPath = path.join(os.tmpdir(), 'atlas-scrape-test.sock');
+    atlas.gauge('scrape.gauge').update(42);
+    native.startScrapeServer({path: socketPath});
+
+    get({socketPath: socketPath, path: '/metrics'}, (err, res, body) => {
+      if (err) {
+        done(err);
+        return;
+      }
+      assert.equal(res.statusCode, 200);
+      assert.match(body, /^scrape_gauge\{.*\} 42$/m);
+      done();
+    });
+  });
+
+  it('should not replace a file that is not a socket', () => {
+    const filePath = path.join(os.tmpdir(), 'atlas-scrape-test.txt');
+    fs.writeFileSync(filePath, 'keep');
+
+    try {
+      assert.throws(() => native.startScrapeServer({path: filePath}),
+        /not a socket/);
+      assert.equal(fs.readFileSync(filePath, 'utf8'), 'keep');
+    } finally {
+      fs.unlinkSync(filePath);
+    }
+  });
+
+  it('should reject unknown paths', (done) => {
+    const port = native.startScrapeServer({port: 0});
+    get({host: '127.0.0.1', port: port, path: '/'}, (err, res) => {
+      if (err) {
+        done(err);
+        return;
+      }
+      assert.equal(res.statusCode, 404);
+      done();
+    });
+  });
+});
@@ -0,0 +1,40 @@
+'use strict';
+
+const atlas = require('../');
+const native = require('bindings')('atlas');
+const chai = require('chai');
+const assert = chai.assert;
+
+describe('self metrics', () => {
+  afterEach(() => native.setSelfMetrics(0));
+
+  it('should count ids, wrappers and time calls', () => {
+    native.setSelfMetrics(1);
+    atlas.counter('self.example', {k: 'v'}).increment();
+    atlas.timer('self.example.timer').record(0, 1000);
+    native.measurements();
+
+    const ids = atlas.counter('atlas.client.idsCreated');
+    assert.isAtLeast(ids.count(), 2);
+    const wrappers = atlas.counter('atlas.client.wrappersCreated', {
+      type: 'timer'
+    });
+    assert.isAtLeast(wrappers.count(), 1);
+    const tagBytes = atlas.counter('atlas.client.tagBytes');
+    assert.isAtLeast(tagBytes.count(), 2);
+    const time = atlas.timer('atlas.client.callTime', {
+      op: 'measurements',
+      sampleRate: '1'
+    });
+    assert.equal(time.count(), 1);
+  });
+
+  it('should not count anything while disabled', () => {
+    native.setSelfMetrics(1);
+    const ids = atlas.counter('atlas.client.idsCreated');
+    native.setSelfMetrics(0);
+    const before = ids.count();
+    atlas.counter('self.disabled').increment();
+    assert.equal(ids.count(), before);
+  });
+});
@@ -0,0 +1,35 @@
+'use strict';
+
+const atlas = require('../');
+const chai = require('chai');
+const assert = chai.assert;
+
+function blockLoopFor(ms) {
+  const end = Date.now() + ms;
+
+  while (Date.now() < end) {
+    // busy
+  }
+}
+
+describe('stall watchdog', () => {
+  afterEach(() => atlas.stopWatchdog());
+
+  it('should count stalls and capture the blocking stack', (done) => {
+    const stalls = atlas.counter('nodejs.eventLoopStall');
+    const before = stalls.count();
+    atlas.startWatchdog({thresholdMs: 50, captureStacks: true});
+
+    setTimeout(() => {
+      blockLoopFor(400);
+      setTimeout(() => {
+        assert.isAbove(stalls.count(), before);
+        const stacks = atlas.stallStacks();
+        assert.isAbove(stacks.length, 0);
+        const frames = stacks.map((s) => s.frames.join('\n')).join('\n');
+        assert.include(frames, 'blockLoopFor');
+        done();
+      }, 200);
+    }, 100);
+  });
+});